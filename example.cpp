@@ -57,11 +57,9 @@ TEST(CustomSuite, TestWithLoop)
         // EXPECT_ONCE/ASSERT_ONCE statements only log the condition from the final loop iteration
         EXPECT_NONZERO_ONCE(suite.testInt);
 
-#if !OSTEST_NO_ALLOC
         // EXPECT_ALL/ASSERT_ALL will log the condition for all loop iterations.
-        // It requires memory allocation.
+        // When OSTEST_NO_ALLOC is set, these are stored in a fixed-size pool.
         EXPECT_ALL(suite.testInt % 2 == 0);
-#endif
         suite.testInt--;
 
         // EXPECT/ASSERT default to EXPECT_ALL/ASSERT_ALL, and so will log for each iteration.
@@ -111,12 +109,20 @@ TEST(CustomSuite, MetadataTest)
 {
     // Metadata should be marked as static in order to persist once the test
     // has completed
-    static Metadata<bool> meta(*this, "shouldFail", true);
+    static Metadata<bool> meta(*this, METADATA_NAME("shouldFail"), true);
 
     ASSERT(true);
 }
 
 
+// Benchmarks are run like tests, with the body repeated many times to gather timings
+BENCHMARK(CustomSuite, LoopBenchmark)
+{
+    volatile int value = suite.testInt;
+    while (value > 0) value = value - 1;
+}
+
+
 // Test suites can be declared within namespaces...
 namespace exampleNS
 {
@@ -166,7 +172,7 @@ void ostest::handleTestComplete(const TestInfo& test, const TestResult& result)
     bool succeeded = result;
 
     // Metadata (if present) is retrieved via 'getMetadata<T>'
-    const Metadata<bool>* shouldFail = test.getMetadata<bool>("shouldFail");
+    const Metadata<bool>* shouldFail = test.getMetadata<bool>(METADATA_NAME("shouldFail"));
 
     // Here we use it to check if the test was intended to fail
     if (shouldFail != nullptr && shouldFail->value) {
@@ -177,6 +183,14 @@ void ostest::handleTestComplete(const TestInfo& test, const TestResult& result)
     printf("[%s] [%s::%s] at %s:%i\n", succeeded ? passStr : failStr,
         test.suite.name, test.name, test.file, test.line);
 
+    // Print benchmark statistics
+    if (const BenchmarkStats* stats = result.getBenchmarkStats())
+    {
+        printf("\t%llu iterations x %u samples: mean %.1fns, median %.1fns, "
+            "p99 %.1fns, stddev %.1fns, %.0f ops/sec\n", stats->iterations, stats->samples,
+            stats->mean, stats->median, stats->p99, stats->stddev, stats->opsPerSecond);
+    }
+
     auto first = result.getFirstFailure();
     auto final = result.getFinalFailure();
 
@@ -0,0 +1,168 @@
+/* ostest-alloc.cpp - (c) 2018 James Renwick */
+#include "ostest-alloc.hpp"
+
+#if OSTEST_TRACK_ALLOCATIONS
+#if OSTEST_NO_ALLOC
+#error Allocation tracking requires allocation: cannot compile with both OSTEST_TRACK_ALLOCATIONS and OSTEST_NO_ALLOC.
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+    static thread_local _AllocationTracker* currentTracker = nullptr;
+
+    // Source of the serials marking the blocks allocated by each tracker. Zero marks
+    // blocks allocated while no tracker was counting.
+    static std::atomic<unsigned long long> trackerSerial{0};
+
+    // Precedes each allocation
+    struct _AllocationHeader
+    {
+        size_t size;
+        unsigned long long serial; // Serial of the tracker which allocated the block
+    };
+
+    // The header is padded to keep the alignment given by 'malloc'
+    static constexpr const size_t _headerSize = (sizeof(_AllocationHeader) + alignof(std::max_align_t) - 1) /
+        alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    static void* _allocate(size_t size) noexcept
+    {
+        auto ptr = static_cast<char*>(std::malloc(_headerSize + (size != 0 ? size : 1)));
+        if (ptr == nullptr) return nullptr;
+
+        auto header = reinterpret_cast<_AllocationHeader*>(ptr);
+        header->size = size;
+        header->serial = currentTracker != nullptr ? currentTracker->allocated(size) : 0;
+        return ptr + _headerSize;
+    }
+
+    static void* _allocateOrThrow(size_t size)
+    {
+        while (true)
+        {
+            if (void* ptr = _allocate(size)) return ptr;
+
+            std::new_handler handler = std::get_new_handler();
+#if OSTEST_STD_EXCEPTIONS
+            if (handler == nullptr) throw std::bad_alloc();
+#else
+            if (handler == nullptr) std::abort();
+#endif
+            handler();
+        }
+    }
+
+    static void _deallocate(void* ptr) noexcept
+    {
+        if (ptr == nullptr) return;
+
+        char* base = static_cast<char*>(ptr) - _headerSize;
+        auto header = reinterpret_cast<_AllocationHeader*>(base);
+        if (auto tracker = currentTracker) tracker->deallocated(header->size, header->serial);
+        std::free(base);
+    }
+
+    _AllocationTracker::_AllocationTracker() : serial(++trackerSerial), previous(currentTracker) {
+        currentTracker = this;
+    }
+
+    void _AllocationTracker::end() noexcept
+    {
+        if (ended) return;
+        ended = true;
+        currentTracker = previous;
+    }
+
+    unsigned long long _AllocationTracker::allocated(size_t size) noexcept
+    {
+        stats.allocations++;
+        stats.bytes += size;
+        liveBytes += size;
+
+        if (liveBytes > stats.peakBytes) stats.peakBytes = liveBytes;
+        return serial;
+    }
+
+    void _AllocationTracker::deallocated(size_t size, unsigned long long serial) noexcept
+    {
+        stats.deallocations++;
+
+        // Memory allocated before the tracker, or by another, is not live within it
+        if (serial == this->serial) liveBytes -= size;
+    }
+
+    _AllocationPause::_AllocationPause() noexcept : tracker(currentTracker) {
+        currentTracker = nullptr;
+    }
+
+    _AllocationPause::~_AllocationPause() {
+        currentTracker = tracker;
+    }
+
+    static constexpr const char* _budgetExpression = "max_allocs";
+
+    class _AllocationBudgetAssertion : public CustomAssertion
+    {
+    private:
+        char text[96];
+
+    public:
+        _AllocationBudgetAssertion(const TestInfo& info, unsigned long long allocations, unsigned int budget)
+            : CustomAssertion(&getText, &destroy, _budgetExpression, _heapalloc_tag{}, info.file, info.line, true)
+        {
+            std::snprintf(text, sizeof(text), "Made %llu allocations, exceeding the budget of %u.",
+                allocations, budget);
+        }
+
+    private:
+        static const char* getText(const CustomAssertion& assertion) {
+            return static_cast<const _AllocationBudgetAssertion&>(assertion).text;
+        }
+        static void destroy(CustomAssertion* assertion) {
+            delete static_cast<_AllocationBudgetAssertion*>(assertion);
+        }
+    };
+
+    void _checkAllocationBudget(UnitTest& test, const AllocationStats& stats)
+    {
+        auto budget = test.getInfo().getMetadata<unsigned int>(OSTEST_METADATA_NAME("max_allocs"));
+        if (budget == nullptr || stats.allocations <= budget->value) return;
+
+        (new _AllocationBudgetAssertion(test.getInfo(), stats.allocations, budget->value))->evaluate(test, false);
+    }
+}
+
+void* operator new(std::size_t size) {
+    return _ostest_internal::_allocateOrThrow(size);
+}
+void* operator new[](std::size_t size) {
+    return _ostest_internal::_allocateOrThrow(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return _ostest_internal::_allocate(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return _ostest_internal::_allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    _ostest_internal::_deallocate(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+    _ostest_internal::_deallocate(ptr);
+}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    _ostest_internal::_deallocate(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    _ostest_internal::_deallocate(ptr);
+}
+#endif
@@ -0,0 +1,61 @@
+/* ostest-alloc.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+
+/* When compiled with 'OSTEST_TRACK_ALLOCATIONS', ostest replaces the global
+   'operator new' and 'operator delete', counting the allocations made by each
+   test body on the thread running the test (see 'TestResult::getAllocationStats').
+
+   Tests may limit their allocations with 'Metadata<unsigned int>' named
+   "max_allocs", failing should the test body make more allocations. */
+#if OSTEST_TRACK_ALLOCATIONS
+namespace _ostest_internal
+{
+    // Counts the allocations made on this thread until ended or destroyed.
+    // Trackers nest, with only the innermost counting.
+    class _AllocationTracker
+    {
+    private:
+        ::ostest::AllocationStats stats{};
+        unsigned long long liveBytes = 0;  // Allocated by this tracker and not yet freed
+        unsigned long long serial;         // Marks the blocks allocated by this tracker
+        _AllocationTracker* previous;
+        bool ended = false;
+
+    public:
+        _AllocationTracker();
+        ~_AllocationTracker() { end(); }
+
+        _AllocationTracker(const _AllocationTracker&) = delete;
+        _AllocationTracker& operator =(const _AllocationTracker&) = delete;
+
+        void end() noexcept;
+
+        inline const ::ostest::AllocationStats& getStats() const noexcept { return stats; }
+
+        // Gets the serial with which to mark a block of the given size
+        unsigned long long allocated(size_t size) noexcept;
+        // Records the freeing of a block of the given size, marked with the given serial
+        void deallocated(size_t size, unsigned long long serial) noexcept;
+    };
+
+    // Stops counting the allocations made on this thread for its lifetime,
+    // excluding those made by ostest itself
+    class _AllocationPause
+    {
+    private:
+        _AllocationTracker* tracker;
+
+    public:
+        _AllocationPause() noexcept;
+        ~_AllocationPause();
+
+        _AllocationPause(const _AllocationPause&) = delete;
+        _AllocationPause& operator =(const _AllocationPause&) = delete;
+    };
+
+    // Fails the test should its allocations exceed its "max_allocs" metadata
+    void _checkAllocationBudget(::ostest::UnitTest& test, const ::ostest::AllocationStats& stats);
+}
+#endif
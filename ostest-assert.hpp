@@ -20,62 +20,266 @@ namespace _ostest_internal
 #define _OSTEST_EXPECTBR_INT(id, expr, cls) { static cls _OSTEST_CONCAT(_assertion, id)(#expr, __FILE__, __LINE__); \
                                      if (!_OSTEST_CONCAT(_assertion, id) .evaluate(*this, (expr))) break; }
 
+/* [internal] Creates a new ostest Unit Test Assertion comparing the given operands. */
+#define _OSTEST_ASSERT_CMP_INT(id, expr, cls, ...) { static cls _OSTEST_CONCAT(_assertion, id)(#expr, __FILE__, __LINE__); \
+                                     if (! _OSTEST_CONCAT(_assertion, id) .evaluate(*this, __VA_ARGS__)) return; }
+
+/* [internal] Creates a new ostest Unit Test Expectation comparing the given operands. */
+#define _OSTEST_EXPECT_CMP_INT(id, expr, cls, ...) { static cls _OSTEST_CONCAT(_assertion, id)(#expr, __FILE__, __LINE__); \
+                                     _OSTEST_CONCAT(_assertion, id) .evaluate(*this, __VA_ARGS__); }
+
+    // The type of an operand captured by a failed comparison
+    enum class _OperandKind : unsigned char
+    {
+        none, boolean, character, signedInt, unsignedInt, floating, pointer, null
+    };
+
+    union _OperandValue
+    {
+        long long s;
+        unsigned long long u;
+        double f;
+        const void* p;
+    };
+
+    inline _OperandKind _capture(bool value, _OperandValue& out) { out.u = value; return _OperandKind::boolean; }
+    inline _OperandKind _capture(char value, _OperandValue& out) { out.s = value; return _OperandKind::character; }
+    inline _OperandKind _capture(signed char value, _OperandValue& out) { out.s = value; return _OperandKind::signedInt; }
+    inline _OperandKind _capture(short value, _OperandValue& out) { out.s = value; return _OperandKind::signedInt; }
+    inline _OperandKind _capture(int value, _OperandValue& out) { out.s = value; return _OperandKind::signedInt; }
+    inline _OperandKind _capture(long value, _OperandValue& out) { out.s = value; return _OperandKind::signedInt; }
+    inline _OperandKind _capture(long long value, _OperandValue& out) { out.s = value; return _OperandKind::signedInt; }
+    inline _OperandKind _capture(unsigned char value, _OperandValue& out) { out.u = value; return _OperandKind::unsignedInt; }
+    inline _OperandKind _capture(unsigned short value, _OperandValue& out) { out.u = value; return _OperandKind::unsignedInt; }
+    inline _OperandKind _capture(unsigned int value, _OperandValue& out) { out.u = value; return _OperandKind::unsignedInt; }
+    inline _OperandKind _capture(unsigned long value, _OperandValue& out) { out.u = value; return _OperandKind::unsignedInt; }
+    inline _OperandKind _capture(unsigned long long value, _OperandValue& out) { out.u = value; return _OperandKind::unsignedInt; }
+    inline _OperandKind _capture(float value, _OperandValue& out) { out.f = value; return _OperandKind::floating; }
+    inline _OperandKind _capture(double value, _OperandValue& out) { out.f = value; return _OperandKind::floating; }
+    inline _OperandKind _capture(long double value, _OperandValue& out) {
+        out.f = static_cast<double>(value); return _OperandKind::floating;
+    }
+    inline _OperandKind _capture(decltype(nullptr), _OperandValue& out) { out.p = nullptr; return _OperandKind::null; }
+
+    template<typename T>
+    inline _OperandKind _capture(T* const& value, _OperandValue& out) {
+        out.p = (const void*)value; return _OperandKind::pointer;
+    }
+
+    template<bool> struct _enum_tag { };
+
+    // Literal zero and NULL convert to any pointer, other integers do not
+    struct _NullLiteral;
+    char _isNullLiteral(_NullLiteral*);
+    char (&_isNullLiteral(...))[2];
+
+    /* [internal] Records which operands of a comparison are null pointer constants. */
+    template<bool NullA, bool NullB> struct _null_tag { };
+
+/* [internal] Gets the '_null_tag' for the given comparison operands. Operands are not evaluated. */
+#define _OSTEST_NULL_TAG(expr1, expr2) ::_ostest_internal::_null_tag< \
+    sizeof(::_ostest_internal::_isNullLiteral(expr1)) == 1, sizeof(::_ostest_internal::_isNullLiteral(expr2)) == 1>{}
+
+    template<typename T, typename O, bool Null>
+    inline const T& _comparand(const T& value, const O&, _enum_tag<Null>) { return value; }
+
+    // A null pointer constant compared with a pointer is compared as 'nullptr'
+    template<typename T, typename O>
+    inline decltype(nullptr) _comparand(const T&, O* const&, _enum_tag<true>) { return nullptr; }
+
+    template<typename T>
+    inline _OperandKind _captureOther(const T& value, _OperandValue& out, _enum_tag<true>) {
+        out.s = static_cast<long long>(value); return _OperandKind::signedInt;
+    }
+    template<typename T>
+    inline _OperandKind _captureOther(const T&, _OperandValue&, _enum_tag<false>) {
+        return _OperandKind::none;
+    }
+
+    // Enumerations are captured by value, other types are not captured
+    template<typename T>
+    inline _OperandKind _capture(const T& value, _OperandValue& out) {
+        return _captureOther(value, out, _enum_tag<__is_enum(T)>{});
+    }
+
+    /* [internal] Records a failed comparison with its captured operands. One is
+       allocated for each failure, so that comparisons hold no operands. The
+       operands are only formatted should its message be requested. */
+    class _ComparisonFailure : public ::ostest::Assertion
+    {
+    private:
+        static constexpr const size_t messageSize = 64;
+
+        _OperandKind kinds[2]{};
+        mutable bool formatted = false;
+        // The operands are replaced by the message once formatted
+        mutable union {
+            _OperandValue operands[2];
+            char message[messageSize];
+        } storage;
+
+    public:
+        template<typename A, typename B>
+        inline _ComparisonFailure(const ::ostest::Assertion& comparison, const A& a, const B& b)
+            : ::ostest::Assertion(comparison.expression, _arenaalloc_tag{}, comparison.file, comparison.line)
+        {
+            this->kind = comparison.getKind();
+            kinds[0] = _capture(a, storage.operands[0]);
+            kinds[1] = _capture(b, storage.operands[1]);
+        }
+
+        /* [internal] Gets the message of the failure, showing the operands where captured. */
+        const char* getComparisonMessage(const char* op, const char* failMsg) const;
+    };
+
+    /* [internal] Base of the comparison assertions. Each derived class differs
+       only in its operator and assertion kind. */
+    class _ComparisonAssertion : public ::ostest::Assertion
+    {
+    protected:
+        inline _ComparisonAssertion(::ostest::AssertionKind kind, const char* expr,
+            const char* file, int line, bool tmp) : ::ostest::Assertion(expr, file, line, tmp) {
+            this->kind = kind;
+        }
+        inline _ComparisonAssertion(::ostest::AssertionKind kind, const char* expr,
+            _arenaalloc_tag tag, const char* file, int line) : ::ostest::Assertion(expr, tag, file, line) {
+            this->kind = kind;
+        }
+
+        /* Records the failure of the comparison of the given operands. */
+        template<typename A, typename B>
+        inline bool fail(::ostest::UnitTest& test, const A& a, const B& b)
+        {
+            auto failure = new (allocateTemporary(test, sizeof(_ComparisonFailure),
+                alignof(_ComparisonFailure))) _ComparisonFailure(*this, a, b);
+            return failure->evaluate(test, false);
+        }
+    };
+
+    // Size and alignment of each slot of the assertion pool used with OSTEST_NO_ALLOC.
+    // Larger assertions, such as comparison failures, take consecutive slots.
+    constexpr const size_t _assertionSlotSize = sizeof(::ostest::Assertion) + 4 * sizeof(void*);
+    constexpr const size_t _assertionSlotAlign = alignof(long double);
+
+#ifndef OSTEST_ASSERTION_POOL_SIZE
+/* The number of temporary assertions which can be recorded when OSTEST_NO_ALLOC is set. */
+#define OSTEST_ASSERTION_POOL_SIZE 256
+#endif
+
+    /* [internal] Gets the size of the given assertion type, checking that it fits
+       within a slot of the assertion pool. */
+    template<typename T>
+    constexpr size_t _assertionSlot()
+    {
+        static_assert(sizeof(T) <= _assertionSlotSize && alignof(T) <= _assertionSlotAlign,
+            "Assertion type too large for the assertion pool used with 'OSTEST_NO_ALLOC'.");
+        return sizeof(T);
+    }
+
 #if !OSTEST_NO_ALLOC
+/* [internal] Allocates a new temporary assertion from the current test's arena. */
+#define _OSTEST_NEW_TEMPORARY(expr, cls) new (this->allocateTemporary(sizeof(cls), alignof(cls))) \
+                                        cls(#expr, ::_ostest_internal::_arenaalloc_tag{}, __FILE__, __LINE__)
+#else
+/* [internal] Allocates a new temporary assertion from the assertion pool. */
+#define _OSTEST_NEW_TEMPORARY(expr, cls) new (this->allocateTemporary( \
+                                            ::_ostest_internal::_assertionSlot<cls>(), alignof(cls))) \
+                                        cls(#expr, ::_ostest_internal::_arenaalloc_tag{}, __FILE__, __LINE__)
+#endif
+
 /* [internal] Creates a new ostest Unit Test Assertion. */
-#define _OSTEST_ASSERT_ALL_INT(expr, cls) { cls* _assert = new cls(#expr, ::_ostest_internal::_heapalloc_tag{}, __FILE__, __LINE__, true); \
+#define _OSTEST_ASSERT_ALL_INT(expr, cls) { cls* _assert = _OSTEST_NEW_TEMPORARY(expr, cls); \
                                         if (!_assert->evaluate(*this, (expr))) return; }
 
 /* [internal] Creates a new ostest Unit Test Expectation. */
-#define _OSTEST_EXPECT_ALL_INT(expr, cls) { cls* _assert = new cls(#expr, ::_ostest_internal::_heapalloc_tag{}, __FILE__, __LINE__, true); \
+#define _OSTEST_EXPECT_ALL_INT(expr, cls) { cls* _assert = _OSTEST_NEW_TEMPORARY(expr, cls); \
                                         _assert->evaluate(*this, (expr)); }
 
 /* [internal] Creates a new ostest Unit Test Expectation. */
-#define _OSTEST_EXPECT_ALLBR_INT(expr, cls) { cls* _assert = new cls(#expr, ::_ostest_internal::_heapalloc_tag{}, __FILE__, __LINE__, true); \
+#define _OSTEST_EXPECT_ALLBR_INT(expr, cls) { cls* _assert = _OSTEST_NEW_TEMPORARY(expr, cls); \
                                         if (!_assert->evaluate(*this, (expr))) break; }
 
-#define _OSTEST_ASSERT_CTOR_ALL_INT(name) \
-        inline name(const char* expr, ::_ostest_internal::_heapalloc_tag, \
-            const char* file, int line, bool tmp) : name(expr, file, line, tmp) { \
-        }
+/* [internal] Creates a new ostest Unit Test Assertion comparing the given operands. */
+#define _OSTEST_ASSERT_CMP_ALL_INT(expr, cls, ...) { cls* _assert = _OSTEST_NEW_TEMPORARY(expr, cls); \
+                                        if (!_assert->evaluate(*this, __VA_ARGS__)) return; }
 
-#else
-// Define macros as being unavailable if OSTEST_NO_ALLOC defined
-#define _OSTEST_ASSERT_ALL_INT(expr, cls) static_assert(false, "ASSERT_ALL unavailable when 'OSTEST_NO_ALLOC' defined.");
-#define _OSTEST_EXPECT_ALL_INT(expr, cls) static_assert(false, "EXPECT_ALL unavailable when 'OSTEST_NO_ALLOC' defined.");
-#define _OSTEST_EXPECT_ALLBR_INT(expr, cls) static_assert(false, "EXPECT_ALL_OR_BREAK unavailable when 'OSTEST_NO_ALLOC' defined.");
-#define _OSTEST_ASSERT_CTOR_ALL_INT(name)
-#endif
+/* [internal] Creates a new ostest Unit Test Expectation comparing the given operands. */
+#define _OSTEST_EXPECT_CMP_ALL_INT(expr, cls, ...) { cls* _assert = _OSTEST_NEW_TEMPORARY(expr, cls); \
+                                        _assert->evaluate(*this, __VA_ARGS__); }
 
 
-#define _OSTEST_ASSERTION_DEF(name, successMsg, failMsg) \
-    class _assert_ ## name : public ::ostest::Assertion \
-    { \
-    public: \
+#define _OSTEST_COMPARISON_CTORS(name, kind) \
         inline _assert_ ## name(const char* expr, const char* file = __FILE__, \
             int line = __LINE__, bool tmp = false) \
-            : ::ostest::Assertion(expr, file, line, tmp) { } \
-        _OSTEST_ASSERT_CTOR_ALL_INT( _assert_ ## name ) \
+            : ::_ostest_internal::_ComparisonAssertion(::ostest::AssertionKind::kind, expr, file, line, tmp) { } \
+        inline _assert_ ## name(const char* expr, ::_ostest_internal::_arenaalloc_tag tag, \
+            const char* file, int line) \
+            : ::_ostest_internal::_ComparisonAssertion(::ostest::AssertionKind::kind, expr, tag, file, line) { } \
+        using ::ostest::Assertion::evaluate;
+
+// The operator and message of each kind are found in a table by 'Assertion::getMessage'
+#define _OSTEST_ASSERTION_DEF(name, op, kind) \
+    class _assert_ ## name : public ::_ostest_internal::_ComparisonAssertion \
+    { \
+    public: \
+        _OSTEST_COMPARISON_CTORS(name, kind) \
     \
+        /* [internal] Compares the operands within the context of the given unit test. */ \
+        template<bool NullA, bool NullB, typename A, typename B> \
+        inline bool evaluate(::ostest::UnitTest& test, ::_ostest_internal::_null_tag<NullA, NullB>, \
+            const A& a, const B& b) \
+        { \
+            if (::_ostest_internal::_comparand(a, b, ::_ostest_internal::_enum_tag<NullA>{}) op \
+                ::_ostest_internal::_comparand(b, a, ::_ostest_internal::_enum_tag<NullB>{})) { \
+                return ::ostest::Assertion::evaluate(test, true); \
+            } \
+            return fail(test, a, b); \
+        } \
+    };
+
+// Compares a single operand with zero. Literal zero allows pointers to be compared.
+#define _OSTEST_ZERO_ASSERTION_DEF(name, op, kind) \
+    class _assert_ ## name : public ::_ostest_internal::_ComparisonAssertion \
+    { \
     public: \
-        const char* getMessage() const override final { \
-            return this->passed() ? emptyMsg : failMsg; \
+        _OSTEST_COMPARISON_CTORS(name, kind) \
+    \
+        /* [internal] Compares the operand within the context of the given unit test. */ \
+        template<typename A> \
+        inline bool evaluate(::ostest::UnitTest& test, const A& a) \
+        { \
+            if ((a) op 0) return ::ostest::Assertion::evaluate(test, true); \
+            return fail(test, a, 0); \
         } \
     };
 
-    _OSTEST_ASSERTION_DEF(ze,  "The value was zero.",        "Expected zero value.")
-    _OSTEST_ASSERTION_DEF(nz,  "The value was non-zero.",    "Expected non-zero value.")
-    _OSTEST_ASSERTION_DEF(eq,  "The values were equal.",     "Expected equal values.")
-    _OSTEST_ASSERTION_DEF(neq, "The values were not equal.", "Expected non-equal values.")
+// Operands are compared as written, so do not warn about comparisons the
+// test author would not be warned about without ostest
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable: 4018 4389)
+#endif
 
-    _OSTEST_ASSERTION_DEF(lt, "The first value was less than the second.",
-        "The first value was not less than the second.")
-    _OSTEST_ASSERTION_DEF(gt, "The first value was greater than the second.",
-        "The first value was not greater than the second.")
-    _OSTEST_ASSERTION_DEF(lte, "The first value was less than or equal to the second.",
-        "The first value was not less than or equal to the second.")
-    _OSTEST_ASSERTION_DEF(gte, "The first value was greater than or equal to the second.",
-        "The first value was not greater than or equal to the second.")
+    _OSTEST_ZERO_ASSERTION_DEF(ze, ==, Zero)
+    _OSTEST_ZERO_ASSERTION_DEF(nz, !=, NonZero)
+    _OSTEST_ASSERTION_DEF(eq,  ==, Equal)
+    _OSTEST_ASSERTION_DEF(neq, !=, NotEqual)
+    _OSTEST_ASSERTION_DEF(lt,  <,  Less)
+    _OSTEST_ASSERTION_DEF(gt,  >,  Greater)
+    _OSTEST_ASSERTION_DEF(lte, <=, LessEqual)
+    _OSTEST_ASSERTION_DEF(gte, >=, GreaterEqual)
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
 
+#undef _OSTEST_ZERO_ASSERTION_DEF
+#undef _OSTEST_COMPARISON_CTORS
 #undef _OSTEST_ASSERTION_DEF
 
 #define _OSTEST_DEFAULT_ALL !OSTEST_NO_ALLOC
@@ -87,41 +291,44 @@ namespace _ostest_internal
 #define OSTEST_EXPECT_ALL_OR_BREAK(expr) _OSTEST_EXPECT_ALLBR_INT(expr, ::ostest::Assertion)
 #define OSTEST_EXPECT_ONCE_OR_BREAK(expr) _OSTEST_EXPECTBR_INT(__COUNTER__, expr, ::ostest::Assertion)
 
-#define OSTEST_ASSERT_ZERO_ONCE(expr)         _OSTEST_ASSERT_INT(__COUNTER__, (expr) == 0, ::_ostest_internal::_assert_ze)
-#define OSTEST_ASSERT_NONZERO_ONCE(expr)      _OSTEST_ASSERT_INT(__COUNTER__, (expr) != 0, ::_ostest_internal::_assert_nz)
-#define OSTEST_ASSERT_EQ_ONCE(expr1, expr2)   _OSTEST_ASSERT_INT(__COUNTER__, (expr1) == (expr2), ::_ostest_internal::_assert_eq)
-#define OSTEST_ASSERT_NEQ_ONCE(expr1, expr2)  _OSTEST_ASSERT_INT(__COUNTER__, (expr1) != (expr2), ::_ostest_internal::_assert_neq)
-#define OSTEST_ASSERT_LT_ONCE(expr1, expr2)   _OSTEST_ASSERT_INT(__COUNTER__, (expr1) < (expr2), ::_ostest_internal::_assert_lt)
-#define OSTEST_ASSERT_GT_ONCE(expr1, expr2)   _OSTEST_ASSERT_INT(__COUNTER__, (expr1) > (expr2), ::_ostest_internal::_assert_gt)
-#define OSTEST_ASSERT_LTEQ_ONCE(expr1, expr2) _OSTEST_ASSERT_INT(__COUNTER__, (expr1) <= (expr2), ::_ostest_internal::_assert_lte)
-#define OSTEST_ASSERT_GTEQ_ONCE(expr1, expr2) _OSTEST_ASSERT_INT(__COUNTER__, (expr1) >= (expr2), ::_ostest_internal::_assert_gte)
-
-#define OSTEST_ASSERT_ZERO_ALL(expr)         _OSTEST_ASSERT_ALL_INT((expr) == 0, ::_ostest_internal::_assert_ze)
-#define OSTEST_ASSERT_NONZERO_ALL(expr)      _OSTEST_ASSERT_ALL_INT( (expr) != 0, ::_ostest_internal::_assert_nz)
-#define OSTEST_ASSERT_EQ_ALL(expr1, expr2)   _OSTEST_ASSERT_ALL_INT((expr1) == (expr2), ::_ostest_internal::_assert_eq)
-#define OSTEST_ASSERT_NEQ_ALL(expr1, expr2)  _OSTEST_ASSERT_ALL_INT((expr1) != (expr2), ::_ostest_internal::_assert_neq)
-#define OSTEST_ASSERT_LT_ALL(expr1, expr2)   _OSTEST_ASSERT_ALL_INT((expr1) < (expr2), ::_ostest_internal::_assert_lt)
-#define OSTEST_ASSERT_GT_ALL(expr1, expr2)   _OSTEST_ASSERT_ALL_INT((expr1) > (expr2), ::_ostest_internal::_assert_gt)
-#define OSTEST_ASSERT_LTEQ_ALL(expr1, expr2) _OSTEST_ASSERT_ALL_INT((expr1) <= (expr2), ::_ostest_internal::_assert_lte)
-#define OSTEST_ASSERT_GTEQ_ALL(expr1, expr2) _OSTEST_ASSERT_ALL_INT((expr1) >= (expr2), ::_ostest_internal::_assert_gte)
-
-#define OSTEST_EXPECT_ZERO_ONCE(expr)         _OSTEST_EXPECT_INT(__COUNTER__, (expr) == 0, ::_ostest_internal::_assert_ze)
-#define OSTEST_EXPECT_NONZERO_ONCE(expr)      _OSTEST_EXPECT_INT(__COUNTER__, (expr) != 0, ::_ostest_internal::_assert_nz)
-#define OSTEST_EXPECT_EQ_ONCE(expr1, expr2)   _OSTEST_EXPECT_INT(__COUNTER__, (expr1) == (expr2), ::_ostest_internal::_assert_eq)
-#define OSTEST_EXPECT_NEQ_ONCE(expr1, expr2)  _OSTEST_EXPECT_INT(__COUNTER__, (expr1) != (expr2), ::_ostest_internal::_assert_neq)
-#define OSTEST_EXPECT_LT_ONCE(expr1, expr2)   _OSTEST_EXPECT_INT(__COUNTER__, (expr1) < (expr2), ::_ostest_internal::_assert_lt)
-#define OSTEST_EXPECT_GT_ONCE(expr1, expr2)   _OSTEST_EXPECT_INT(__COUNTER__, (expr1) > (expr2), ::_ostest_internal::_assert_gt)
-#define OSTEST_EXPECT_LTEQ_ONCE(expr1, expr2) _OSTEST_EXPECT_INT(__COUNTER__, (expr1) <= (expr2), ::_ostest_internal::_assert_lte)
-#define OSTEST_EXPECT_GTEQ_ONCE(expr1, expr2) _OSTEST_EXPECT_INT(__COUNTER__, (expr1) >= (expr2), ::_ostest_internal::_assert_gte)
-
-#define OSTEST_EXPECT_ZERO_ALL(expr)         _OSTEST_EXPECT_ALL_INT((expr) == 0, ::_ostest_internal::_assert_ze)
-#define OSTEST_EXPECT_NONZERO_ALL(expr)      _OSTEST_EXPECT_ALL_INT( (expr) != 0, ::_ostest_internal::_assert_nz)
-#define OSTEST_EXPECT_EQ_ALL(expr1, expr2)   _OSTEST_EXPECT_ALL_INT((expr1) == (expr2), ::_ostest_internal::_assert_eq)
-#define OSTEST_EXPECT_NEQ_ALL(expr1, expr2)  _OSTEST_EXPECT_ALL_INT((expr1) != (expr2), ::_ostest_internal::_assert_neq)
-#define OSTEST_EXPECT_LT_ALL(expr1, expr2)   _OSTEST_EXPECT_ALL_INT((expr1) < (expr2), ::_ostest_internal::_assert_lt)
-#define OSTEST_EXPECT_GT_ALL(expr1, expr2)   _OSTEST_EXPECT_ALL_INT((expr1) > (expr2), ::_ostest_internal::_assert_gt)
-#define OSTEST_EXPECT_LTEQ_ALL(expr1, expr2) _OSTEST_EXPECT_ALL_INT((expr1) <= (expr2), ::_ostest_internal::_assert_lte)
-#define OSTEST_EXPECT_GTEQ_ALL(expr1, expr2) _OSTEST_EXPECT_ALL_INT((expr1) >= (expr2), ::_ostest_internal::_assert_gte)
+#define OSTEST_ASSERT_EACH(expr) _OSTEST_ASSERT_INT(__COUNTER__, expr, ::ostest::EachAssertion)
+#define OSTEST_EXPECT_EACH(expr) _OSTEST_EXPECT_INT(__COUNTER__, expr, ::ostest::EachAssertion)
+
+#define OSTEST_ASSERT_ZERO_ONCE(expr)         _OSTEST_ASSERT_CMP_INT(__COUNTER__, (expr) == 0, ::_ostest_internal::_assert_ze, (expr))
+#define OSTEST_ASSERT_NONZERO_ONCE(expr)      _OSTEST_ASSERT_CMP_INT(__COUNTER__, (expr) != 0, ::_ostest_internal::_assert_nz, (expr))
+#define OSTEST_ASSERT_EQ_ONCE(expr1, expr2)   _OSTEST_ASSERT_CMP_INT(__COUNTER__, (expr1) == (expr2), ::_ostest_internal::_assert_eq, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_ASSERT_NEQ_ONCE(expr1, expr2)  _OSTEST_ASSERT_CMP_INT(__COUNTER__, (expr1) != (expr2), ::_ostest_internal::_assert_neq, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_ASSERT_LT_ONCE(expr1, expr2)   _OSTEST_ASSERT_CMP_INT(__COUNTER__, (expr1) < (expr2), ::_ostest_internal::_assert_lt, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_ASSERT_GT_ONCE(expr1, expr2)   _OSTEST_ASSERT_CMP_INT(__COUNTER__, (expr1) > (expr2), ::_ostest_internal::_assert_gt, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_ASSERT_LTEQ_ONCE(expr1, expr2) _OSTEST_ASSERT_CMP_INT(__COUNTER__, (expr1) <= (expr2), ::_ostest_internal::_assert_lte, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_ASSERT_GTEQ_ONCE(expr1, expr2) _OSTEST_ASSERT_CMP_INT(__COUNTER__, (expr1) >= (expr2), ::_ostest_internal::_assert_gte, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+
+#define OSTEST_ASSERT_ZERO_ALL(expr)         _OSTEST_ASSERT_CMP_ALL_INT((expr) == 0, ::_ostest_internal::_assert_ze, (expr))
+#define OSTEST_ASSERT_NONZERO_ALL(expr)      _OSTEST_ASSERT_CMP_ALL_INT((expr) != 0, ::_ostest_internal::_assert_nz, (expr))
+#define OSTEST_ASSERT_EQ_ALL(expr1, expr2)   _OSTEST_ASSERT_CMP_ALL_INT((expr1) == (expr2), ::_ostest_internal::_assert_eq, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_ASSERT_NEQ_ALL(expr1, expr2)  _OSTEST_ASSERT_CMP_ALL_INT((expr1) != (expr2), ::_ostest_internal::_assert_neq, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_ASSERT_LT_ALL(expr1, expr2)   _OSTEST_ASSERT_CMP_ALL_INT((expr1) < (expr2), ::_ostest_internal::_assert_lt, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_ASSERT_GT_ALL(expr1, expr2)   _OSTEST_ASSERT_CMP_ALL_INT((expr1) > (expr2), ::_ostest_internal::_assert_gt, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_ASSERT_LTEQ_ALL(expr1, expr2) _OSTEST_ASSERT_CMP_ALL_INT((expr1) <= (expr2), ::_ostest_internal::_assert_lte, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_ASSERT_GTEQ_ALL(expr1, expr2) _OSTEST_ASSERT_CMP_ALL_INT((expr1) >= (expr2), ::_ostest_internal::_assert_gte, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+
+#define OSTEST_EXPECT_ZERO_ONCE(expr)         _OSTEST_EXPECT_CMP_INT(__COUNTER__, (expr) == 0, ::_ostest_internal::_assert_ze, (expr))
+#define OSTEST_EXPECT_NONZERO_ONCE(expr)      _OSTEST_EXPECT_CMP_INT(__COUNTER__, (expr) != 0, ::_ostest_internal::_assert_nz, (expr))
+#define OSTEST_EXPECT_EQ_ONCE(expr1, expr2)   _OSTEST_EXPECT_CMP_INT(__COUNTER__, (expr1) == (expr2), ::_ostest_internal::_assert_eq, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_EXPECT_NEQ_ONCE(expr1, expr2)  _OSTEST_EXPECT_CMP_INT(__COUNTER__, (expr1) != (expr2), ::_ostest_internal::_assert_neq, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_EXPECT_LT_ONCE(expr1, expr2)   _OSTEST_EXPECT_CMP_INT(__COUNTER__, (expr1) < (expr2), ::_ostest_internal::_assert_lt, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_EXPECT_GT_ONCE(expr1, expr2)   _OSTEST_EXPECT_CMP_INT(__COUNTER__, (expr1) > (expr2), ::_ostest_internal::_assert_gt, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_EXPECT_LTEQ_ONCE(expr1, expr2) _OSTEST_EXPECT_CMP_INT(__COUNTER__, (expr1) <= (expr2), ::_ostest_internal::_assert_lte, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_EXPECT_GTEQ_ONCE(expr1, expr2) _OSTEST_EXPECT_CMP_INT(__COUNTER__, (expr1) >= (expr2), ::_ostest_internal::_assert_gte, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+
+#define OSTEST_EXPECT_ZERO_ALL(expr)         _OSTEST_EXPECT_CMP_ALL_INT((expr) == 0, ::_ostest_internal::_assert_ze, (expr))
+#define OSTEST_EXPECT_NONZERO_ALL(expr)      _OSTEST_EXPECT_CMP_ALL_INT((expr) != 0, ::_ostest_internal::_assert_nz, (expr))
+#define OSTEST_EXPECT_EQ_ALL(expr1, expr2)   _OSTEST_EXPECT_CMP_ALL_INT((expr1) == (expr2), ::_ostest_internal::_assert_eq, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_EXPECT_NEQ_ALL(expr1, expr2)  _OSTEST_EXPECT_CMP_ALL_INT((expr1) != (expr2), ::_ostest_internal::_assert_neq, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_EXPECT_LT_ALL(expr1, expr2)   _OSTEST_EXPECT_CMP_ALL_INT((expr1) < (expr2), ::_ostest_internal::_assert_lt, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_EXPECT_GT_ALL(expr1, expr2)   _OSTEST_EXPECT_CMP_ALL_INT((expr1) > (expr2), ::_ostest_internal::_assert_gt, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_EXPECT_LTEQ_ALL(expr1, expr2) _OSTEST_EXPECT_CMP_ALL_INT((expr1) <= (expr2), ::_ostest_internal::_assert_lte, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
+#define OSTEST_EXPECT_GTEQ_ALL(expr1, expr2) _OSTEST_EXPECT_CMP_ALL_INT((expr1) >= (expr2), ::_ostest_internal::_assert_gte, _OSTEST_NULL_TAG(expr1, expr2), (expr1), (expr2))
 
 
 #if _OSTEST_DEFAULT_ALL
@@ -179,6 +386,8 @@ namespace _ostest_internal
 #define EXPECT_OR_BREAK(expr) OSTEST_EXPECT_OR_BREAK(expr)
 #define EXPECT_ONCE_OR_BREAK(expr) OSTEST_EXPECT_ONCE_OR_BREAK(expr)
 #define EXPECT_ALL_OR_BREAK(expr) OSTEST_EXPECT_ALL_OR_BREAK(expr)
+#define ASSERT_EACH(expr) OSTEST_ASSERT_EACH(expr)
+#define EXPECT_EACH(expr) OSTEST_EXPECT_EACH(expr)
 
 #define ASSERT_ZERO(expr) OSTEST_ASSERT_ZERO(expr)
 #define ASSERT_NONZERO(expr) OSTEST_ASSERT_NONZERO(expr)
@@ -0,0 +1,207 @@
+/* ostest-async.cpp - (c) 2018 James Renwick */
+#include "ostest-async.hpp"
+
+#if OSTEST_STD_THREADS
+#if OSTEST_NO_ALLOC
+#error Thread support requires allocation: cannot compile with both OSTEST_STD_THREADS and OSTEST_NO_ALLOC.
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+    struct _AsyncSlot
+    {
+        // Equal to the position when empty, and the position plus one when full
+        std::atomic<size_t> sequence{};
+        const TestInfo* info{};
+        alignas(TestResult) unsigned char result[sizeof(TestResult)];
+    };
+
+    // Bounded multi-producer, single-consumer queue of completed tests.
+    // Producers claim a position with a single CAS, then publish the slot.
+    struct _AsyncQueue
+    {
+        _AsyncSlot* slots;
+        size_t mask;
+        AsyncReporter::Handler handler;
+
+        std::atomic<size_t> enqueuePos{0};
+        char padding[64]{}; // Keep the producers' and consumer's counters on separate cache lines
+        std::atomic<size_t> handledCount{0};
+        size_t dequeuePos = 0;
+
+        std::atomic<bool> stopping{false};
+        std::atomic<bool> sleeping{false};
+        std::mutex idleLock{};
+        std::condition_variable idle{};
+
+        // Producers waiting for space, and callers of 'flush', wait on the consumer's progress
+        std::atomic<unsigned int> waiters{0};
+        std::mutex progressLock{};
+        std::condition_variable progress{};
+        std::thread thread{};
+
+        _AsyncQueue(size_t capacity, AsyncReporter::Handler handler) : handler(handler)
+        {
+            size_t size = 2;
+            while (size < capacity) size *= 2;
+            slots = new _AsyncSlot[size];
+            mask = size - 1;
+            for (size_t i = 0; i < size; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+
+            thread = std::thread([this]() { consume(); });
+        }
+
+        ~_AsyncQueue()
+        {
+            stopping.store(true);
+            wake();
+            thread.join();
+            delete[] slots;
+        }
+
+        // Wakes the consumer should it be sleeping. The fence pairs with that in 'consume',
+        // so that either the consumer sees the published slot, or we see it sleeping.
+        void wake()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<std::mutex> guard(idleLock);
+                idle.notify_one();
+            }
+        }
+
+        // Waits until the consumer has made enough progress for the given condition to hold
+        template<typename Condition>
+        void waitForProgress(Condition condition)
+        {
+            wake();
+
+            std::unique_lock<std::mutex> lock(progressLock);
+            waiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!condition()) progress.wait(lock);
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        void push(const TestInfo& info, const TestResult& result)
+        {
+            size_t pos = enqueuePos.load(std::memory_order_relaxed);
+            _AsyncSlot* slot;
+            while (true)
+            {
+                slot = &slots[pos & mask];
+                auto difference = static_cast<long>(slot->sequence.load(std::memory_order_acquire) - pos);
+
+                if (difference == 0)
+                {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                }
+                // The queue is full - wait for the reporter to catch up
+                else if (difference < 0)
+                {
+                    waitForProgress([slot, pos]() {
+                        return static_cast<long>(slot->sequence.load(std::memory_order_acquire) - pos) >= 0;
+                    });
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+                else pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+
+            slot->info = &info;
+            new (slot->result) TestResult(result);
+            slot->sequence.store(pos + 1, std::memory_order_release);
+            wake();
+        }
+
+        // Handles the next test if one is ready
+        bool pop()
+        {
+            _AsyncSlot& slot = slots[dequeuePos & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) return false;
+
+            auto& result = *reinterpret_cast<TestResult*>(slot.result);
+            handler(*slot.info, result);
+            result.~TestResult();
+
+            slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+            dequeuePos++;
+            handledCount.fetch_add(1, std::memory_order_release);
+
+            // Pairs with the fence in 'waitForProgress'
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters.load(std::memory_order_relaxed) != 0)
+            {
+                std::lock_guard<std::mutex> guard(progressLock);
+                progress.notify_all();
+            }
+            return true;
+        }
+
+        void consume()
+        {
+            while (true)
+            {
+                if (pop()) continue;
+                if (stopping.load() && handledCount.load() == enqueuePos.load()) return;
+
+                // Sleep until woken. Producers publish before checking whether we sleep,
+                // and we sleep before checking for a published slot, so neither is missed.
+                std::unique_lock<std::mutex> lock(idleLock);
+                sleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (slots[dequeuePos & mask].sequence.load(std::memory_order_relaxed) != dequeuePos + 1 &&
+                    !stopping.load(std::memory_order_relaxed))
+                {
+                    idle.wait(lock);
+                }
+                sleeping.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        void flush()
+        {
+            size_t target = enqueuePos.load();
+            waitForProgress([this, target]() {
+                return handledCount.load(std::memory_order_acquire) >= target;
+            });
+        }
+    };
+
+    static std::atomic<AsyncReporter*> activeReporter{nullptr};
+}
+
+namespace ostest
+{
+    using namespace ::_ostest_internal;
+
+    AsyncReporter::AsyncReporter(size_t capacity, Handler handler)
+        : queue(new _AsyncQueue(capacity, handler)), previous(activeReporter.exchange(this)) { }
+
+    AsyncReporter::~AsyncReporter()
+    {
+        activeReporter.store(previous);
+        delete queue;
+    }
+
+    void AsyncReporter::push(const TestInfo& info, const TestResult& result) {
+        queue->push(info, result);
+    }
+
+    void AsyncReporter::flush() {
+        queue->flush();
+    }
+
+    AsyncReporter* AsyncReporter::getActive() noexcept {
+        return activeReporter.load();
+    }
+}
+#endif
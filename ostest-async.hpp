@@ -0,0 +1,58 @@
+/* ostest-async.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+
+#if OSTEST_STD_THREADS
+namespace _ostest_internal
+{
+    struct _AsyncQueue;
+}
+
+namespace ostest
+{
+    /* Handles completed tests on a dedicated reporter thread.
+
+       While an asynchronous reporter exists, the default 'notifyComplete' of each
+       runner pushes the completed test onto a bounded lock-free queue, from which
+       the reporter thread passes it to the handler. Should the queue be full,
+       runners wait for space. Handlers are called one at a time, in the order in
+       which tests were queued. The queue is drained when the reporter is destroyed.
+
+       Results share their assertions with the runner. Those made with the _ONCE
+       variants are only valid until the test is next run, so call 'flush' before
+       re-running tests which use them.
+       Requires ostest to be compiled with 'OSTEST_STD_THREADS'. */
+    class AsyncReporter
+    {
+    public:
+        using Handler = void (*)(const TestInfo& info, const TestResult& result);
+
+    private:
+        _ostest_internal::_AsyncQueue* queue;
+        AsyncReporter* previous;
+
+    public:
+        /* Creates a new asynchronous reporter, passing tests to the given handler.
+           The queue capacity is rounded up to a power of two. */
+        explicit AsyncReporter(_ostest_internal::size_t capacity = 1024,
+            Handler handler = &::ostest::handleTestComplete);
+
+        AsyncReporter(const AsyncReporter&) = delete;
+        AsyncReporter& operator =(const AsyncReporter&) = delete;
+
+        /* Handles all queued tests, then stops the reporter thread. */
+        ~AsyncReporter();
+
+    public:
+        /* Queues the completed test, waiting while the queue is full. Thread-safe. */
+        void push(const TestInfo& info, const TestResult& result);
+
+        /* Waits until all tests queued before the call have been handled. */
+        void flush();
+
+        /* Gets the most recently created reporter which still exists, or null. */
+        static AsyncReporter* getActive() noexcept;
+    };
+}
+#endif
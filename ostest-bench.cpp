@@ -0,0 +1,131 @@
+/* ostest-bench.cpp - (c) 2018 James Renwick */
+#include "ostest-bench.hpp"
+
+
+namespace ostest
+{
+    static BenchmarkOptions benchmarkOptions{};
+
+    void setBenchmarkOptions(const BenchmarkOptions& options) noexcept {
+        benchmarkOptions = options;
+    }
+
+    const BenchmarkOptions& getBenchmarkOptions() noexcept {
+        return benchmarkOptions;
+    }
+
+
+    /* Class representing an assertion that a benchmark could be timed. */
+    class BenchmarkClockAssertion : public CustomAssertion
+    {
+    public:
+        BenchmarkClockAssertion() : CustomAssertion(&message, "<benchmark clock>", __FILE__, __LINE__) { }
+
+    private:
+        static const char* message(const CustomAssertion& assertion) {
+            return assertion.passed() ? "" : "No wall clock is available to time the benchmark.";
+        }
+    };
+
+
+    // Sorts the given values in ascending order
+    static void sort(double* values, unsigned int count)
+    {
+        for (unsigned int i = 1; i < count; i++)
+        {
+            double value = values[i];
+            unsigned int j = i;
+            for (; j > 0 && values[j - 1] > value; j--) values[j] = values[j - 1];
+            values[j] = value;
+        }
+    }
+
+    // Calculates the square root of the given non-negative value
+    static double sqrt(double value)
+    {
+        if (value <= 0) return 0;
+
+        double root = value >= 1 ? value : 1;
+        for (int i = 0; i < 64; i++)
+        {
+            double next = (root + value / root) / 2;
+            if (next >= root) break;
+            root = next;
+        }
+        return root;
+    }
+
+    unsigned long long Benchmark::runBatch(TimingClock clock, unsigned long long iterations)
+    {
+        unsigned long long start = clock();
+        for (unsigned long long i = 0; i < iterations; i++) benchmarkBody();
+        return clock() - start;
+    }
+
+    void Benchmark::testBody()
+    {
+        TimingClock clock, cpuClock;
+        getTimingClocks(clock, cpuClock);
+
+        if (clock == nullptr)
+        {
+            static BenchmarkClockAssertion assertion{};
+            assertion.evaluate(*this, false);
+            return;
+        }
+
+        const BenchmarkOptions options = benchmarkOptions;
+        unsigned int sampleCount = options.sampleCount;
+        if (sampleCount == 0) sampleCount = 1;
+        if (sampleCount > BenchmarkOptions::maxSamples) sampleCount = BenchmarkOptions::maxSamples;
+
+        // Run once to check that the benchmark body succeeds
+        unsigned long long warmUpStart = clock();
+        unsigned long long time = runBatch(clock, 1);
+        if (!result.succeeded()) return;
+
+        // Scale up the iteration count until each sample is long enough to time
+        unsigned long long iterations = 1;
+        while (time < options.minSampleTime)
+        {
+            unsigned long long scale = time == 0 ? 10 : options.minSampleTime / time + 1;
+            if (scale < 2) scale = 2;
+            if (scale > 10) scale = 10;
+
+            iterations *= scale;
+            time = runBatch(clock, iterations);
+        }
+        while (clock() - warmUpStart < options.warmUpTime) {
+            runBatch(clock, iterations);
+        }
+
+        // Take samples of the time per iteration
+        double samples[BenchmarkOptions::maxSamples];
+        double total = 0;
+        for (unsigned int i = 0; i < sampleCount; i++)
+        {
+            samples[i] = static_cast<double>(runBatch(clock, iterations)) / iterations;
+            total += samples[i];
+        }
+
+        BenchmarkStats stats{};
+        stats.iterations = iterations;
+        stats.samples = sampleCount;
+        stats.mean = total / sampleCount;
+
+        double variance = 0;
+        for (unsigned int i = 0; i < sampleCount; i++) {
+            variance += (samples[i] - stats.mean) * (samples[i] - stats.mean);
+        }
+        stats.stddev = sampleCount > 1 ? sqrt(variance / (sampleCount - 1)) : 0;
+
+        sort(samples, sampleCount);
+        stats.median = sampleCount % 2 == 1 ? samples[sampleCount / 2] :
+            (samples[sampleCount / 2 - 1] + samples[sampleCount / 2]) / 2;
+        // Nearest-rank percentile
+        stats.p99 = samples[(sampleCount * 99 + 99) / 100 - 1];
+        stats.opsPerSecond = stats.mean > 0 ? 1e9 / stats.mean : 0;
+
+        result.setBenchmarkStats(stats);
+    }
+}
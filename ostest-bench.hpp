@@ -0,0 +1,62 @@
+/* ostest-bench.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+
+namespace ostest
+{
+    /* Options controlling how benchmarks are measured.
+       Times are in wall clock ticks - the defaults assume a nanosecond clock. */
+    struct BenchmarkOptions
+    {
+        static constexpr const unsigned int maxSamples = 128;
+
+        unsigned long long minSampleTime = 1000000;  // Minimum time taken by each sample
+        unsigned long long warmUpTime = 10000000;    // Time spent running before sampling
+        unsigned int sampleCount = 32;               // Samples taken, up to 'maxSamples'
+    };
+
+    /* Sets the options used to measure benchmarks. */
+    void setBenchmarkOptions(const BenchmarkOptions& options) noexcept;
+
+    /* Gets the options used to measure benchmarks. */
+    const BenchmarkOptions& getBenchmarkOptions() noexcept;
+
+
+    /* Base class of benchmarks. The benchmark body is run repeatedly, between
+       a single call to the suite's setUp and tearDown.
+
+       Iteration counts are chosen such that each sample takes at least
+       'BenchmarkOptions::minSampleTime', and the body is run for
+       'BenchmarkOptions::warmUpTime' before samples are taken.
+       Statistics are available from 'TestResult::getBenchmarkStats'. */
+    class Benchmark : public UnitTest
+    {
+    protected:
+        /* Creates (but does not register) a new Benchmark. */
+        inline Benchmark(const TestInfo& info) : UnitTest(info) { }
+
+        /* The body of the benchmark - a single iteration. */
+        virtual void benchmarkBody() = 0;
+
+    private:
+        void testBody() override final;
+
+        unsigned long long runBatch(TimingClock clock, unsigned long long iterations);
+    };
+}
+
+
+/* Creates a new OSTest Benchmark. */
+#define OSTEST_BENCHMARK(suiteName, benchmarkName) \
+    _OSTEST_INTERNAL_EX(::ostest::Benchmark, benchmarkBody, true, suiteName, suiteName, benchmarkName)
+
+/* Creates a new OSTest Benchmark. */
+#define OSTEST_BENCHMARK_EX(suiteNamespace, suiteName, benchmarkName) \
+    _OSTEST_INTERNAL_EX(::ostest::Benchmark, benchmarkBody, true, suiteNamespace::suiteName, suiteName, benchmarkName)
+
+
+#if !OSTEST_MUST_PREFIX
+#define BENCHMARK(suiteName, benchmarkName) OSTEST_BENCHMARK(suiteName, benchmarkName)
+#define BENCHMARK_EX(suiteNamespace, suiteName, benchmarkName) OSTEST_BENCHMARK_EX(suiteNamespace, suiteName, benchmarkName)
+#endif
@@ -0,0 +1,310 @@
+/* ostest-filter.cpp - (c) 2018 James Renwick */
+#include "ostest.hpp"
+
+#if !OSTEST_NO_ALLOC
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+    static bool _hasWildcard(const char* start, const char* end)
+    {
+        for (; start != end; start++) {
+            if (*start == '*' || *start == '?') return true;
+        }
+        return false;
+    }
+
+    // Name matched by a pattern - either "SuiteName.TestName" or "TestName" alone
+    struct _FilterName
+    {
+        const char* suite;
+        size_t suiteLength;
+        const char* test;
+        size_t testLength;
+
+        size_t length() const noexcept {
+            return suite == nullptr ? testLength : suiteLength + 1 + testLength;
+        }
+
+        char operator [](size_t i) const noexcept
+        {
+            if (suite == nullptr) return test[i];
+            if (i < suiteLength) return suite[i];
+            return i == suiteLength ? '.' : test[i - suiteLength - 1];
+        }
+    };
+
+    // Matches the name against the pattern, where '*' matches any string and '?' any character
+    static bool _globMatch(const char* pattern, const char* patternEnd, const _FilterName& name)
+    {
+        const char* star = nullptr;
+        size_t starIndex = 0;
+        size_t i = 0;
+        size_t length = name.length();
+
+        while (i < length)
+        {
+            if (pattern != patternEnd && (*pattern == '?' || *pattern == name[i])) {
+                pattern++; i++;
+            }
+            else if (pattern != patternEnd && *pattern == '*') {
+                star = pattern++;
+                starIndex = i;
+            }
+            // Let the last '*' consume one more character
+            else if (star != nullptr) {
+                pattern = star + 1;
+                i = ++starIndex;
+            }
+            else return false;
+        }
+        while (pattern != patternEnd && *pattern == '*') pattern++;
+        return pattern == patternEnd;
+    }
+
+    struct _IndexedSuite
+    {
+        SuiteInfo* suite;
+        size_t nameLength;
+        unsigned int hash;
+        size_t firstTest;
+        size_t testCount;
+    };
+
+    struct _IndexedTest
+    {
+        const TestInfo* test;
+        size_t suite;
+        size_t nameLength;
+        unsigned int hash; // Hash of "SuiteName.TestName"
+    };
+
+    // Index over the names of all registered tests, built once on first use.
+    // Tests of a suite are contiguous and in registration order.
+    struct _TestIndex
+    {
+        _IndexedSuite* suites{};
+        size_t suiteCount{};
+        _IndexedTest* tests{};
+        size_t testCount{};
+        _HashIndex suiteTable{};
+        _HashIndex testTable{};
+
+        _TestIndex()
+        {
+            // Tests of a suite are adjacent in registration order
+            auto allTests = _getAllTests(testCount);
+            for (size_t t = 0; t < testCount; t++) {
+                if (t == 0 || &allTests[t]->suite != &allTests[t - 1]->suite) suiteCount++;
+            }
+            suites = new _IndexedSuite[suiteCount];
+            tests = new _IndexedTest[testCount];
+
+            size_t s = 0;
+            for (size_t t = 0; t < testCount; t++)
+            {
+                auto& suite = const_cast<SuiteInfo&>(allTests[t]->suite);
+                if (t == 0 || &suite != suites[s - 1].suite)
+                {
+                    _IndexedSuite& entry = suites[s++];
+                    entry.suite = &suite;
+                    entry.nameLength = _length(suite.name);
+                    entry.hash = _hashRange(suite.name, entry.nameLength);
+                    entry.firstTest = t;
+                    entry.testCount = 0;
+                }
+                _IndexedSuite& entry = suites[s - 1];
+                entry.testCount++;
+
+                _IndexedTest& item = tests[t];
+                item.test = allTests[t];
+                item.suite = s - 1;
+                item.nameLength = _length(item.test->name);
+                item.hash = _hashTestName(entry.hash, item.test->name, item.nameLength);
+            }
+            delete[] allTests;
+            suiteTable.rebuild(suiteCount, [this](size_t index) { return suites[index].hash; });
+            testTable.rebuild(testCount, [this](size_t index) { return tests[index].hash; });
+        }
+
+        _TestIndex(const _TestIndex&) = delete;
+        _TestIndex& operator =(const _TestIndex&) = delete;
+
+        ~_TestIndex()
+        {
+            delete[] suites;
+            delete[] tests;
+        }
+
+        _FilterName fullName(size_t index) const noexcept
+        {
+            const _IndexedTest& test = tests[index];
+            const _IndexedSuite& suite = suites[test.suite];
+            return _FilterName{suite.suite->name, suite.nameLength, test.test->name, test.nameLength};
+        }
+
+        size_t findSuite(const char* name, size_t length) const noexcept
+        {
+            unsigned int hash = _hashRange(name, length);
+            size_t found = suiteTable.find(hash, [&](size_t index) {
+                const _IndexedSuite& suite = suites[index];
+                return suite.hash == hash && _equal(suite.suite->name, suite.nameLength, name, length);
+            });
+            return found != _notFound ? found : suiteCount;
+        }
+
+        size_t findTest(size_t suite, const char* name, size_t length) const noexcept
+        {
+            unsigned int hash = _hashTestName(suites[suite].hash, name, length);
+            size_t found = testTable.find(hash, [&](size_t index) {
+                const _IndexedTest& test = tests[index];
+                return test.hash == hash && test.suite == suite &&
+                    _equal(test.test->name, test.nameLength, name, length);
+            });
+            return found != _notFound ? found : testCount;
+        }
+    };
+
+    static _TestIndex& _getIndex()
+    {
+        static _TestIndex index{};
+        return index;
+    }
+
+    // Builds a selection from a filter string against the test index
+    class _FilterSelection
+    {
+    private:
+        _TestIndex& index;
+        const char* negative;    // Start of the negative patterns, or null
+        const char* negativeEnd;
+        bool* selected;          // Whether each test is selected, to de-duplicate the selection
+
+    public:
+        size_t* positions;
+        size_t count = 0;
+
+        _FilterSelection(_TestIndex& index, const char* negative, const char* negativeEnd)
+            : index(index), negative(negative), negativeEnd(negativeEnd),
+              selected(new bool[index.testCount]{}), positions(new size_t[index.testCount]) { }
+
+        _FilterSelection(const _FilterSelection&) = delete;
+        _FilterSelection& operator =(const _FilterSelection&) = delete;
+
+        ~_FilterSelection()
+        {
+            delete[] selected;
+            delete[] positions;
+        }
+
+        bool excluded(size_t position) const
+        {
+            if (negative == nullptr) return false;
+
+            _FilterName name = index.fullName(position);
+            for (const char* start = negative; start <= negativeEnd;)
+            {
+                const char* end = start;
+                while (end != negativeEnd && *end != ':') end++;
+                if (end != start && _globMatch(start, end, name)) return true;
+                start = end + 1;
+            }
+            return false;
+        }
+
+        void select(size_t position)
+        {
+            if (selected[position] || excluded(position)) return;
+            selected[position] = true;
+            positions[count++] = position;
+        }
+
+        // Selects the tests matched by a single positive pattern
+        void selectPattern(const char* pattern, const char* end)
+        {
+            const char* dot = pattern;
+            while (dot != end && *dot != '.') dot++;
+
+            // Suites which can be found by name
+            if (dot != end && !_hasWildcard(pattern, dot))
+            {
+                size_t suite = index.findSuite(pattern, static_cast<size_t>(dot - pattern));
+                if (suite == index.suiteCount) return;
+
+                const _IndexedSuite& entry = index.suites[suite];
+                if (!_hasWildcard(dot + 1, end))
+                {
+                    size_t test = index.findTest(suite, dot + 1, static_cast<size_t>(end - dot - 1));
+                    if (test != index.testCount) select(test);
+                    return;
+                }
+                for (size_t t = entry.firstTest; t < entry.firstTest + entry.testCount; t++)
+                {
+                    const _IndexedTest& test = index.tests[t];
+                    if (_globMatch(dot + 1, end, _FilterName{nullptr, 0, test.test->name, test.nameLength})) {
+                        select(t);
+                    }
+                }
+                return;
+            }
+            for (size_t t = 0; t < index.testCount; t++) {
+                if (_globMatch(pattern, end, index.fullName(t))) select(t);
+            }
+        }
+
+        // Sorts the selected positions into registration order
+        void sort() {
+            _sort(positions, count, [](size_t a, size_t b) { return a < b; });
+        }
+    };
+}
+
+namespace ostest
+{
+    using namespace ::_ostest_internal;
+
+    TestFilter::TestFilter(const char* filter)
+    {
+        _TestIndex& index = _getIndex();
+
+        // Split at the first '-' into positive and negative patterns
+        const char* positiveEnd = filter;
+        while (*positiveEnd != '\0' && *positiveEnd != '-') positiveEnd++;
+        const char* negative = *positiveEnd == '-' ? positiveEnd + 1 : nullptr;
+        const char* negativeEnd = negative ? negative + _length(negative) : nullptr;
+
+        _FilterSelection selection(index, negative, negativeEnd);
+        bool anyPositive = false;
+
+        for (const char* start = filter; start <= positiveEnd;)
+        {
+            const char* end = start;
+            while (end != positiveEnd && *end != ':') end++;
+            if (end != start)
+            {
+                anyPositive = true;
+                selection.selectPattern(start, end);
+            }
+            start = end + 1;
+        }
+        if (!anyPositive) {
+            for (size_t t = 0; t < index.testCount; t++) selection.select(t);
+        }
+        selection.sort();
+
+        selected = new const TestInfo*[selection.count];
+        count = selection.count;
+        for (size_t i = 0; i < count; i++) {
+            selected[i] = index.tests[selection.positions[i]].test;
+        }
+    }
+
+    TestFilter::~TestFilter() {
+        delete[] selected;
+    }
+
+    void TestFilter::run() {
+        _runTests(selected, count);
+    }
+}
+#endif
@@ -0,0 +1,49 @@
+/* ostest-filter.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+
+#if !OSTEST_NO_ALLOC
+namespace ostest
+{
+    /* Selects tests by name using Google Test-style filter patterns.
+
+       A filter is a ':'-separated list of positive patterns, optionally followed
+       by '-' and a ':'-separated list of negative patterns, e.g.
+       "Suite.*:-Suite.Slow*". Patterns are matched against "SuiteName.TestName",
+       where '*' matches any string and '?' any single character. Should there be
+       no positive patterns, every test not matched by a negative pattern is selected.
+
+       The names of all registered tests are indexed when the first filter is
+       created. Patterns whose suite name contains no wildcards are resolved
+       through the index, so only that suite's tests are compared. The index is
+       not modified once built, so filters may be created from multiple threads.
+       Not available with 'OSTEST_NO_ALLOC'. */
+    class TestFilter
+    {
+    private:
+        const TestInfo** selected{};
+        _ostest_internal::size_t count{};
+
+    public:
+        /* Creates a new filter, selecting the tests matched by the given patterns. */
+        explicit TestFilter(const char* filter);
+
+        TestFilter(const TestFilter&) = delete;
+        TestFilter& operator =(const TestFilter&) = delete;
+
+        ~TestFilter();
+
+    public:
+        /* Gets the selected tests, in registration order. */
+        inline const TestInfo* const* tests() const noexcept { return selected; }
+
+        /* Gets the number of selected tests. */
+        inline _ostest_internal::size_t getCount() const noexcept { return count; }
+
+        /* Runs the selected tests in order. Suite instances are only created
+           for suites with at least one selected test. */
+        void run();
+    };
+}
+#endif
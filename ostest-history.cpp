@@ -0,0 +1,245 @@
+/* ostest-history.cpp - (c) 2018 James Renwick */
+#include "ostest.hpp"
+
+#if !OSTEST_NO_ALLOC
+#include <cstdio>
+
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+    static constexpr const char* _historyHeader = "ostest-history 1\n";
+
+    struct _HistoryEntry
+    {
+        char* key;             // The suite name and test name, each null-terminated
+        size_t suiteLength;
+        unsigned int hash;
+        unsigned long long duration;
+        bool failed;
+
+        inline const char* suite() const noexcept { return key; }
+        inline const char* name() const noexcept { return key + suiteLength + 1; }
+    };
+
+    // A test read from a cache file
+    struct _HistoryLine
+    {
+        const char* suite;
+        size_t suiteLength;
+        const char* name;
+        size_t nameLength;
+        unsigned long long duration;
+        bool failed;
+    };
+
+    // Parses "<duration> <failed> <suite> <name>\n", advancing past the line
+    static bool _parseLine(const char*& ptr, const char* end, _HistoryLine& line)
+    {
+        if (ptr == end || *ptr < '0' || *ptr > '9') return false;
+        line.duration = 0;
+        for (; ptr != end && *ptr >= '0' && *ptr <= '9'; ptr++) {
+            line.duration = line.duration * 10 + static_cast<unsigned int>(*ptr - '0');
+        }
+
+        if (end - ptr < 3 || ptr[0] != ' ' || (ptr[1] != '0' && ptr[1] != '1') || ptr[2] != ' ') return false;
+        line.failed = ptr[1] == '1';
+        ptr += 3;
+
+        line.suite = ptr;
+        while (ptr != end && *ptr != ' ' && *ptr != '\n') ptr++;
+        line.suiteLength = static_cast<size_t>(ptr - line.suite);
+        if (ptr == end || *ptr != ' ' || line.suiteLength == 0) return false;
+
+        line.name = ++ptr;
+        while (ptr != end && *ptr != ' ' && *ptr != '\n') ptr++;
+        line.nameLength = static_cast<size_t>(ptr - line.name);
+        if (ptr == end || *ptr != '\n' || line.nameLength == 0) return false;
+        ptr++;
+        return true;
+    }
+
+    struct _HistoryOrder
+    {
+        const TestInfo* test;
+        size_t position;
+        unsigned long long duration;
+        bool known;
+        bool failed;
+    };
+
+    // Returns true if 'a' should be run before 'b'
+    static bool _runsBefore(const _HistoryOrder& a, const _HistoryOrder& b, bool failedFirst)
+    {
+        if (failedFirst && a.failed != b.failed) return a.failed;
+        if (a.known != b.known) return !a.known;
+        if (a.duration != b.duration) return a.duration > b.duration;
+        return a.position < b.position;
+    }
+}
+
+namespace ostest
+{
+    using namespace ::_ostest_internal;
+
+    TestHistory::TestHistory(const char* path)
+    {
+        size_t length = _length(path);
+        this->path = new char[length + 1];
+        for (size_t i = 0; i <= length; i++) this->path[i] = path[i];
+
+        load(path);
+    }
+
+    TestHistory::~TestHistory()
+    {
+        for (size_t i = 0; i < count; i++) delete[] entries[i].key;
+        delete[] entries;
+        delete[] path;
+    }
+
+    _HistoryEntry* TestHistory::find(const char* suite, const char* name) const noexcept
+    {
+        size_t suiteLength = _length(suite), nameLength = _length(name);
+        unsigned int hash = _hashTestName(_hashRange(suite, suiteLength), name, nameLength);
+
+        size_t index = table.find(hash, [&](size_t index) {
+            const _HistoryEntry& entry = entries[index];
+            return entry.hash == hash && _equal(entry.suite(), entry.suiteLength, suite, suiteLength) &&
+                _streq(entry.name(), name);
+        });
+        return index != _notFound ? &entries[index] : nullptr;
+    }
+
+    _HistoryEntry& TestHistory::insert(const char* suite, const char* name)
+    {
+        if (auto entry = find(suite, name)) return *entry;
+
+        if (count == capacity)
+        {
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            auto newEntries = new _HistoryEntry[capacity];
+            for (size_t i = 0; i < count; i++) newEntries[i] = entries[i];
+            delete[] entries;
+            entries = newEntries;
+        }
+
+        size_t suiteLength = _length(suite), nameLength = _length(name);
+        _HistoryEntry& entry = entries[count];
+        entry.key = new char[suiteLength + nameLength + 2];
+        for (size_t i = 0; i <= suiteLength; i++) entry.key[i] = suite[i];
+        for (size_t i = 0; i <= nameLength; i++) entry.key[suiteLength + 1 + i] = name[i];
+        entry.suiteLength = suiteLength;
+        entry.hash = _hashTestName(_hashRange(suite, suiteLength), name, nameLength);
+        entry.duration = 0;
+        entry.failed = false;
+
+        table.add(count++, [this](size_t index) { return entries[index].hash; });
+        return entry;
+    }
+
+    bool TestHistory::load(const char* path)
+    {
+        size_t size;
+        char* data = _readFile(path, size);
+        if (data == nullptr) return false;
+
+        const char* end = data + size;
+        size_t headerLength = _length(_historyHeader);
+        bool valid = _equal(data, size < headerLength ? size : headerLength, _historyHeader, headerLength);
+
+        // Check the whole file before adding any tests
+        _HistoryLine line{};
+        const char* ptr = data + headerLength;
+        while (valid && ptr != end) valid = _parseLine(ptr, end, line);
+
+        for (ptr = data + headerLength; valid && ptr != end;)
+        {
+            _parseLine(ptr, end, line);
+
+            // Copy the names to terminate them
+            char* key = new char[line.suiteLength + line.nameLength + 2];
+            for (size_t i = 0; i < line.suiteLength; i++) key[i] = line.suite[i];
+            key[line.suiteLength] = '\0';
+            for (size_t i = 0; i < line.nameLength; i++) key[line.suiteLength + 1 + i] = line.name[i];
+            key[line.suiteLength + line.nameLength + 1] = '\0';
+
+            _HistoryEntry& entry = insert(key, key + line.suiteLength + 1);
+            entry.duration = line.duration;
+            entry.failed = line.failed;
+            delete[] key;
+        }
+        delete[] data;
+        return valid;
+    }
+
+    bool TestHistory::save(const char* path) const
+    {
+        if (path == nullptr) path = this->path;
+        if (path == nullptr) return false;
+
+        std::FILE* file = std::fopen(path, "wb");
+        if (file == nullptr) return false;
+
+        bool success = std::fputs(_historyHeader, file) >= 0;
+        for (size_t i = 0; i < count && success; i++)
+        {
+            auto& entry = entries[i];
+            success = std::fprintf(file, "%llu %d %s %s\n", entry.duration,
+                entry.failed ? 1 : 0, entry.suite(), entry.name()) > 0;
+        }
+        return std::fclose(file) == 0 && success;
+    }
+
+    void TestHistory::record(const TestInfo& test, const TestResult& result)
+    {
+        _HistoryEntry& entry = insert(test.suite.name, test.name);
+        entry.duration = result.getTimings().total().wallTime;
+        entry.failed = !result.succeeded();
+    }
+
+    void TestHistory::record(const ResultLog& log)
+    {
+        for (size_t i = 0; i < log.getTestCount(); i++)
+        {
+            LogTest test = log.getTest(i);
+            _HistoryEntry& entry = insert(test.suite, test.name);
+            entry.duration = test.duration.wallTime;
+            entry.failed = !test.passed;
+        }
+    }
+
+    bool TestHistory::getDuration(const TestInfo& test, unsigned long long& duration) const noexcept
+    {
+        auto entry = find(test.suite.name, test.name);
+        if (entry == nullptr) return false;
+        duration = entry->duration;
+        return true;
+    }
+
+    bool TestHistory::hasFailed(const TestInfo& test) const noexcept
+    {
+        auto entry = find(test.suite.name, test.name);
+        return entry != nullptr && entry->failed;
+    }
+
+    void TestHistory::schedule(const TestInfo** tests, size_t count, bool failedFirst) const
+    {
+        auto order = new _HistoryOrder[count > 0 ? count : 1];
+        for (size_t i = 0; i < count; i++)
+        {
+            auto entry = find(tests[i]->suite.name, tests[i]->name);
+            order[i] = _HistoryOrder{tests[i], i, entry ? entry->duration : 0,
+                entry != nullptr, entry != nullptr && entry->failed};
+        }
+
+        // Positions break ties, so the order is as a stable sort would give
+        _sort(order, count, [failedFirst](const _HistoryOrder& a, const _HistoryOrder& b) {
+            return _runsBefore(a, b, failedFirst);
+        });
+
+        for (size_t i = 0; i < count; i++) tests[i] = order[i].test;
+        delete[] order;
+    }
+}
+#endif
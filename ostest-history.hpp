@@ -0,0 +1,82 @@
+/* ostest-history.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+
+#if !OSTEST_NO_ALLOC
+namespace _ostest_internal
+{
+    struct _HistoryEntry;
+}
+
+namespace ostest
+{
+    class ResultLog;
+
+    /* The durations and outcomes of tests in earlier runs, keyed by suite and test name.
+
+       Histories are stored in a small text cache file, holding the most recent
+       wall-clock duration of each test and whether it failed. Runners given a
+       history record each test as it completes, and schedule tests longest-first.
+       Not available with 'OSTEST_NO_ALLOC'. */
+    class TestHistory
+    {
+    private:
+        _ostest_internal::_HistoryEntry* entries{};
+        _ostest_internal::size_t count{};
+        _ostest_internal::size_t capacity{};
+        _ostest_internal::_HashIndex table{}; // Entries, by the hash of their names
+        char* path{};
+
+    public:
+        /* Creates an empty history. */
+        TestHistory() noexcept = default;
+
+        /* Creates a history stored in the given cache file, loading it should it exist. */
+        explicit TestHistory(const char* path);
+
+        TestHistory(const TestHistory&) = delete;
+        TestHistory& operator =(const TestHistory&) = delete;
+
+        ~TestHistory();
+
+    public:
+        /* Gets the cache file given on construction, or null. */
+        inline const char* getPath() const noexcept { return path; }
+
+        /* Gets the number of tests recorded. */
+        inline _ostest_internal::size_t getCount() const noexcept { return count; }
+
+        /* Adds the tests held in the given cache file, replacing those already
+           recorded. Returns false should the file not exist or be invalid. */
+        bool load(const char* path);
+
+        /* Writes the history to the given cache file, or that given on construction. */
+        bool save(const char* path = nullptr) const;
+
+        /* Records the duration and outcome of a completed test. */
+        void record(const TestInfo& test, const TestResult& result);
+
+        /* Records each test held in a binary result log. */
+        void record(const ResultLog& log);
+
+        /* Gets the recorded wall-clock duration of the given test.
+           Returns false should the test not have been recorded. */
+        bool getDuration(const TestInfo& test, unsigned long long& duration) const noexcept;
+
+        /* Returns true if the test failed when last recorded. */
+        bool hasFailed(const TestInfo& test) const noexcept;
+
+        /* Orders the given tests longest-first, preserving the given order between
+           tests of equal duration. Tests not yet recorded are placed first, as their
+           duration is unknown. Should 'failedFirst' be set, tests which failed when
+           last run are placed before all others. */
+        void schedule(const TestInfo** tests, _ostest_internal::size_t count,
+            bool failedFirst = false) const;
+
+    private:
+        _ostest_internal::_HistoryEntry* find(const char* suite, const char* name) const noexcept;
+        _ostest_internal::_HistoryEntry& insert(const char* suite, const char* name);
+    };
+}
+#endif
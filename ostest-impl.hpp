@@ -1,6 +1,10 @@
 /* ostest-impl.hpp - (c) 2016-2018 James Renwick */
 #pragma once
 
+#if OSTEST_SECTION_REGISTRATION && !defined(__GNUC__)
+#error Section-based test registration requires a GNU-compatible compiler and linker.
+#endif
+
 namespace ostest
 {
     class UnitTest;
@@ -11,7 +15,9 @@ namespace ostest
     class TestResult;
     class TestEnumerator;
     class Assertion;
+    enum class RetentionPolicy : unsigned char;
     class UnitTestWrapper;
+    class Benchmark;
 
     template<typename T>
     class Iterable;
@@ -95,7 +101,7 @@ namespace _ostest_internal
     public:
         T* firstItem = nullptr;  // The first item in the linked list.
         T* finalItem = nullptr;  // The last item in the linked list.
-        unsigned long itemCount; // The number of items in the linked list.
+        unsigned long itemCount = 0; // The number of items in the linked list.
 
         void addItem(T* item)
         {
@@ -128,20 +134,226 @@ namespace _ostest_internal
     // Type used to select an overload when the object is heap-allocated
     struct _heapalloc_tag { };
 
+    // Type used to select an overload when the object is allocated from a test's arena
+    struct _arenaalloc_tag { };
+
+    // Type used to select an overload when the object is constant-initialized
+    struct _constinit_tag { };
+
+    // Holds the constant-initialized SuiteInfo for a suite class
+    template<typename T>
+    struct _SuiteRegistration;
+
+    // Reference-counted data shared between copies of a TestResult
+    struct _ResultData;
+
+    // Watches a running test for timeout
+    class _Watch;
+
+    // Summary of the assertions in a TestResult, maintained as they are evaluated
+    struct _ResultSummary
+    {
+        unsigned long serial = 0;   // Identifies the result to its assertions
+        unsigned int passCount = 0;
+        unsigned int failCount = 0;
+        ::ostest::Assertion* firstFailure = nullptr;
+        ::ostest::Assertion* finalFailure = nullptr;
+        unsigned int droppedCount = 0; // Assertions not recorded as the pool was full
+        bool droppedFailure = false;   // Whether an assertion which was not recorded failed
+
+        ::ostest::RetentionPolicy retention{}; // Which passing temporary assertions are kept
+        unsigned int passLimit = 0;            // The number kept with 'KeepLastPasses'
+        unsigned int keptPasses = 0;
+        unsigned int releasedCount = 0;
+        ::ostest::Assertion* oldestPass = nullptr; // Precedes no kept passing temporary assertion
+    };
+
+    // Adds a character to a 32-bit FNV-1a hash
+    constexpr unsigned int _hashStep(unsigned int hash, char c) {
+        return (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+
+    // Hashes the given string (32-bit FNV-1a). Evaluated at compile time for literals.
+    constexpr unsigned int _hashName(const char* str, unsigned int hash = 2166136261u) {
+        return *str == '\0' ? hash : _hashName(str + 1, _hashStep(hash, *str));
+    }
+
+    // Continues the hash of '_hashName' over the given characters
+    inline unsigned int _hashRange(const char* str, size_t length, unsigned int hash = _hashName(""))
+    {
+        for (size_t i = 0; i < length; i++) hash = _hashStep(hash, str[i]);
+        return hash;
+    }
+
+    inline size_t _length(const char* str)
+    {
+        size_t length = 0;
+        while (str[length] != '\0') length++;
+        return length;
+    }
+
+    inline bool _streq(const char* s1, const char* s2)
+    {
+        for (; *s1 == *s2; s1++, s2++) {
+            if (*s1 == '\0') return true;
+        }
+        return false;
+    }
+
+    // Compares two strings by their unsigned characters, as 'strcmp' would
+    inline int _compare(const char* s1, const char* s2)
+    {
+        for (; *s1 == *s2; s1++, s2++) {
+            if (*s1 == '\0') return 0;
+        }
+        return static_cast<unsigned char>(*s1) < static_cast<unsigned char>(*s2) ? -1 : 1;
+    }
+
+    inline bool _equal(const char* a, size_t aLength, const char* b, size_t bLength)
+    {
+        if (aLength != bLength) return false;
+        for (size_t i = 0; i < aLength; i++) {
+            if (a[i] != b[i]) return false;
+        }
+        return true;
+    }
+
+    // Hashes "SuiteName.TestName" as '_hashName' would, given the '_hashRange' of the suite name
+    inline unsigned int _hashTestName(unsigned int suiteHash, const char* name, size_t nameLength) {
+        return _hashRange(name, nameLength, _hashStep(suiteHash, '.'));
+    }
+
+    // Hashes "SuiteName.TestName" as '_hashName' would
+    inline unsigned int _hashTestName(const char* suite, const char* name)
+    {
+        unsigned int hash = _hashName("");
+        for (; *suite != '\0'; suite++) hash = _hashStep(hash, *suite);
+        hash = _hashStep(hash, '.');
+        for (; *name != '\0'; name++) hash = _hashStep(hash, *name);
+        return hash;
+    }
+
+    // Sorts the items so that none is 'before' that preceding it. Not stable,
+    // so ties must be broken by 'before' where the order matters.
+    template<typename T, typename Before>
+    void _sort(T* items, size_t count, Before before)
+    {
+        for (size_t gap = count / 2; gap > 0; gap /= 2)
+        {
+            for (size_t i = gap; i < count; i++)
+            {
+                T value = items[i];
+                size_t j = i;
+                for (; j >= gap && before(value, items[j - gap]); j -= gap) {
+                    items[j] = items[j - gap];
+                }
+                items[j] = value;
+            }
+        }
+    }
+
+    // Runs the given tests in order, sharing a suite instance between adjacent
+    // tests of the same suite. Tests given in registration order are grouped by suite.
+    void _runTests(const ::ostest::TestInfo* const* tests, size_t count);
+
+#if !OSTEST_NO_ALLOC
+    // Collects every registered test, in registration order, into a new array of
+    // at least one element
+    const ::ostest::TestInfo** _getAllTests(size_t& count);
+
+    // Index value given for items not found by '_HashIndex::find'
+    constexpr const size_t _notFound = ~static_cast<size_t>(0);
+
+    // Open-addressed hash table of indices into an array, kept at most half full.
+    // Indices are stored plus one, so that zero is empty.
+    class _HashIndex
+    {
+    private:
+        size_t* slots{};
+        size_t mask{};
+
+    public:
+        _HashIndex() = default;
+        ~_HashIndex() { delete[] slots; }
+
+        _HashIndex(const _HashIndex&) = delete;
+        _HashIndex& operator =(const _HashIndex&) = delete;
+
+        // Replaces the table with one holding indices [0, count), hashed by 'hashOf(index)'
+        template<typename HashOf>
+        void rebuild(size_t count, HashOf hashOf)
+        {
+            size_t size = 16;
+            while (size < count * 2) size *= 2;
+            delete[] slots;
+            slots = new size_t[size]{};
+            mask = size - 1;
+
+            for (size_t i = 0; i < count; i++) insert(hashOf(i), i);
+        }
+
+        // Adds the next index of the array, growing the table as required
+        template<typename HashOf>
+        void add(size_t index, HashOf hashOf)
+        {
+            if (slots == nullptr || (index + 1) * 2 > mask + 1) rebuild(index + 1, hashOf);
+            else insert(hashOf(index), index);
+        }
+
+        // Finds the index with the given hash for which 'matches(index)' holds, or '_notFound'
+        template<typename Matches>
+        size_t find(unsigned int hash, Matches matches) const
+        {
+            if (slots == nullptr) return _notFound;
+
+            for (size_t slot = hash & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+                if (matches(slots[slot] - 1)) return slots[slot] - 1;
+            }
+            return _notFound;
+        }
+
+    private:
+        void insert(unsigned int hash, size_t index)
+        {
+            size_t slot = hash & mask;
+            while (slots[slot] != 0) slot = (slot + 1) & mask;
+            slots[slot] = index + 1;
+        }
+    };
+
+    // Reads a whole file into a new array, returning null should it not be readable
+    char* _readFile(const char* path, size_t& size);
+#endif
+
+    // The name of an item of metadata with its hash, as given by 'OSTEST_METADATA_NAME'
+    struct _MetadataName
+    {
+        const char* name;
+        unsigned int hash;
+    };
+
+    // Holds a hash as a template argument, so that it is computed at compile time
+    template<unsigned int Hash>
+    struct _hashConstant
+    {
+        static constexpr const unsigned int value = Hash;
+    };
+
     // Type representing an item of metadata in a linked list
     struct _MetadataItem
     {
-        friend ostest::UnitTest;
+        friend ostest::TestInfo;
 
     public:
         const char* name{};
 
     protected:
+        unsigned int hash{};
         _MetadataItem* nextItem{};
-        ostest::UnitTest& test;
+        const ostest::TestInfo& test;
         void* item{};
 
-        _MetadataItem(ostest::UnitTest& test, const char* name, void* item);
+        _MetadataItem(ostest::UnitTest& test, const _MetadataName& name, void* item);
         virtual ~_MetadataItem();
     };
 
@@ -192,6 +404,23 @@ namespace _ostest_internal
     };
 }
 
+namespace ostest
+{
+    template<typename T>
+    class Metadata;
+}
+
+namespace _ostest_internal
+{
+    // Called once metadata has been created within a test
+    template<typename T>
+    inline void _metadataCreated(const ::ostest::Metadata<T>&) noexcept { }
+#if OSTEST_STD_THREADS
+    // Applies 'timeout_ms' metadata to the running test
+    void _metadataCreated(const ::ostest::Metadata<unsigned int>& metadata) noexcept;
+#endif
+}
+
 namespace ostest
 {
     template<typename T>
@@ -205,46 +434,79 @@ namespace ostest
         Metadata& operator=(const Metadata&) = delete;
         Metadata& operator=(Metadata&&) = delete;
 
-        /* Creates a new metadata instance. */
+        /* Creates a new metadata instance. The name is given by 'OSTEST_METADATA_NAME'. */
         template<typename Test>
-        Metadata(Test& test, const char* name) :
+        Metadata(Test& test, const _ostest_internal::_MetadataName& name) :
             _ostest_internal::_MetadataItem(test, name, this)
         {
             static_assert(_ostest_internal::is_test_type<Test>::value,
                 "'test' must be a valid pointer to a unit test");
             static_assert(!_ostest_internal::is_pointer_type<T>::value,
                 "Metadata raw pointers will not be freed. Consider wrapping in smart pointer.");
+            _ostest_internal::_metadataCreated(*this);
         }
-        /* Creates a new metadata instance. */
+        /* Creates a new metadata instance. The name is given by 'OSTEST_METADATA_NAME'. */
         template<typename Test, typename Y = T>
-        Metadata(Test& test, const char* name, Y&& value) :
+        Metadata(Test& test, const _ostest_internal::_MetadataName& name, Y&& value) :
             _ostest_internal::_MetadataItem(test, name, this),
             value(_ostest_internal::forward<Y>(value))
         {
             static_assert(_ostest_internal::is_test_type<Test>::value,
                 "'test' must be a valid pointer to a unit test");
+            _ostest_internal::_metadataCreated(*this);
         }
     };
 
 
+    /* Identifies the type of an assertion, and so how its message is produced. */
+    enum class AssertionKind : unsigned char
+    {
+        Basic,        // A boolean condition
+        Zero,         // Comparisons, whose failure messages show the compared values
+        NonZero,
+        Equal,
+        NotEqual,
+        Less,
+        Greater,
+        LessEqual,
+        GreaterEqual,
+        Each,         // An 'EachAssertion', counting the outcomes of repeated evaluations
+        Custom        // A 'CustomAssertion', providing its own message
+    };
+
+    /* An assertion made by a test. Assertions are not polymorphic: the message
+       of each is found from its kind, so that the built-in assertions need not
+       carry a vtable. Other types of assertion derive from 'CustomAssertion'.
+
+       With 'OSTEST_STD_THREADS', assertions may also be made on threads started
+       by the test. These are queued, then recorded in the order made once the
+       test body and tear-down complete, so such threads must be joined first.
+       As an assertion made once per call site may be shared between threads,
+       each evaluation on another thread is recorded as a copy. Copies of custom
+       assertions give the message of a basic assertion. */
     class Assertion
     {
         friend class _ostest_internal::_LinkedListIterator<Assertion>;
         friend class TestResult;
 
     private:
-        bool result = true;
         Assertion* nextItem = nullptr;
         Assertion* prevItem = nullptr;
-
-    protected:
-        const bool temporary;
+        unsigned long owner = 0; // Serial of the result whose list contains this assertion
 
     public:
         const char* expression; // The assertion expression
         const char* file;       // The file in which the assertion is made
         const int line;         // The line at which the assertion is made
 
+    protected:
+        AssertionKind kind = AssertionKind::Basic;
+
+    private:
+        bool result : 1;
+        bool arena : 1;     // Allocated from the result's arena
+        bool temporary : 1; // Deleted along with the result, unless arena-allocated
+
     public:
         /* [internal] Creates (but does not register) a new Assertion instance. */
         Assertion(const char* expression, const char* file = __FILE__,
@@ -255,7 +517,29 @@ namespace ostest
         Assertion(const char* expression, _ostest_internal::_heapalloc_tag,
             const char* file = __FILE__, int line = __LINE__, bool temporary = false);
 
-        virtual ~Assertion() { }
+        /* [internal] Creates (but does not register) a new temporary Assertion instance
+           allocated from a test's arena. Its destructor is not called - the arena is
+           released along with the test's result.
+           When built with OSTEST_NO_ALLOC, the arena is a statically reserved pool. */
+        Assertion(const char* expression, _ostest_internal::_arenaalloc_tag,
+            const char* file = __FILE__, int line = __LINE__);
+
+        Assertion(const Assertion&) = delete;
+        Assertion& operator =(const Assertion&) = delete;
+
+        // Define placement new for arena-allocated assertions
+        inline void* operator new(_ostest_internal::size_t, void* where) noexcept {
+            return where;
+        }
+        inline void operator delete(void*, void*) noexcept { }
+
+        // Heap-allocated assertions use the global allocator
+        inline void* operator new(_ostest_internal::size_t size) {
+            return ::operator new(size);
+        }
+        inline void operator delete(void* ptr) noexcept {
+            ::operator delete(ptr);
+        }
 
     protected:
         static constexpr const char* emptyMsg = "";
@@ -264,10 +548,11 @@ namespace ostest
         /* Returns true if the assertion passed, false otherwise. */
         inline bool passed() const { return result; }
 
+        /* Gets the kind of the assertion. */
+        inline AssertionKind getKind() const noexcept { return kind; }
+
         /* Gets a description of the assertion outcome. */
-        virtual const char* getMessage() const {
-            return result ? emptyMsg : "The assertion failed.";
-        }
+        const char* getMessage() const;
 
         /* Returns true if the assertion passed. False otherwise. */
         inline operator bool() const {
@@ -276,6 +561,116 @@ namespace ostest
 
         /* [internal] Performs an assertion within the context of the given unit test. */
         bool evaluate(UnitTest& test, bool expression);
+
+        /* [internal] Performs an assertion, recording it in the given result. */
+        bool evaluate(TestResult& result, bool expression);
+
+    protected:
+        /* [internal] Returns true if the assertion is recorded in the current result of the given test. */
+        inline bool isRecordedIn(const UnitTest& test) const noexcept;
+
+#if OSTEST_STD_THREADS
+        /* [internal] Returns true if the given test is running on another thread. */
+        static bool isForeignThread(const UnitTest& test) noexcept;
+#endif
+
+        /* [internal] Allocates storage for a temporary assertion made by the given test. */
+        static void* allocateTemporary(UnitTest& test, _ostest_internal::size_t size,
+            _ostest_internal::size_t align);
+
+    private:
+        // Deletes a heap-allocated assertion of any kind
+        static void destroy(Assertion* assertion);
+    };
+
+    /* Base of assertions whose messages are not provided by ostest. The message
+       is given by a function, rather than a virtual method. Heap-allocated
+       assertions must also give a function deleting them as their derived type. */
+    class CustomAssertion : public Assertion
+    {
+        friend class Assertion;
+
+    public:
+        using MessageFunction = const char* (*)(const CustomAssertion& assertion);
+        using DestroyFunction = void (*)(CustomAssertion* assertion);
+
+    private:
+        MessageFunction message;
+        DestroyFunction destroyer = nullptr;
+
+    public:
+        /* [internal] Creates (but does not register) a new CustomAssertion instance. */
+        inline CustomAssertion(MessageFunction message, const char* expression,
+            const char* file = __FILE__, int line = __LINE__)
+            : Assertion(expression, file, line), message(message) { kind = AssertionKind::Custom; }
+
+        /* [internal] Creates (but does not register) a new heap-allocated CustomAssertion
+           instance, deleted by the given function. */
+        inline CustomAssertion(MessageFunction message, DestroyFunction destroyer,
+            const char* expression, _ostest_internal::_heapalloc_tag tag,
+            const char* file = __FILE__, int line = __LINE__, bool temporary = false)
+            : Assertion(expression, tag, file, line, temporary), message(message), destroyer(destroyer) {
+            kind = AssertionKind::Custom;
+        }
+
+        /* [internal] Creates (but does not register) a new arena-allocated CustomAssertion instance. */
+        inline CustomAssertion(MessageFunction message, const char* expression,
+            _ostest_internal::_arenaalloc_tag tag, const char* file = __FILE__, int line = __LINE__)
+            : Assertion(expression, tag, file, line), message(message) { kind = AssertionKind::Custom; }
+    };
+
+    /* An assertion made once per call site, which counts the outcomes of each
+       evaluation rather than recording them, so that it may be used within
+       loops of any length. The indices of the first and final failing
+       evaluations are kept. The counts restart with each run of the test.
+       Made by the 'EXPECT_EACH' and 'ASSERT_EACH' macros. Must only be used on
+       the thread running the test. */
+    class EachAssertion : public Assertion
+    {
+        friend class Assertion;
+
+    private:
+        static constexpr const _ostest_internal::size_t messageSize = 128;
+
+        unsigned long long evaluations = 0;
+        unsigned long long failures = 0;
+        unsigned long long firstFailure = 0;
+        unsigned long long finalFailure = 0;
+        mutable unsigned long long formattedAt = 0; // The evaluation count when formatted, or zero
+        mutable char message[messageSize];
+
+    public:
+        /* [internal] Creates (but does not register) a new EachAssertion instance. */
+        inline EachAssertion(const char* expr, const char* file = __FILE__, int line = __LINE__)
+            : Assertion(expr, file, line) { kind = AssertionKind::Each; }
+
+        using Assertion::evaluate;
+
+        /* [internal] Counts an evaluation within the context of the given unit test. */
+        inline bool evaluate(UnitTest& test, bool value)
+        {
+            if (!isRecordedIn(test)) restart(test);
+            unsigned long long index = evaluations++;
+            if (!value) fail(test, index);
+            return value;
+        }
+
+    public:
+        /* Gets the number of times the assertion was evaluated. */
+        inline unsigned long long getEvaluations() const noexcept { return evaluations; }
+        /* Gets the number of evaluations which passed. */
+        inline unsigned long long getPasses() const noexcept { return evaluations - failures; }
+        /* Gets the number of evaluations which failed. */
+        inline unsigned long long getFailures() const noexcept { return failures; }
+        /* Gets the zero-based index of the first evaluation to fail. Only valid if any failed. */
+        inline unsigned long long getFirstFailure() const noexcept { return firstFailure; }
+        /* Gets the zero-based index of the final evaluation to fail. Only valid if any failed. */
+        inline unsigned long long getFinalFailure() const noexcept { return finalFailure; }
+
+    private:
+        void restart(UnitTest& test);
+        void fail(UnitTest& test, unsigned long long index);
+        const char* getEachMessage() const;
     };
 
     /* Object allowing assertion/expectation iteration. */
@@ -306,13 +701,154 @@ namespace ostest
         }
     };
 
+    /* Clock function returning the current time as a tick count. */
+    using TimingClock = unsigned long long (*)();
+
+    /* Sets the clocks used to time tests. Either may be nullptr, in which
+       case the corresponding times are recorded as zero. */
+    void setTimingClocks(TimingClock wallClock, TimingClock cpuClock) noexcept;
+
+    /* Restores the default timing clocks. With 'OSTEST_POSIX' these are the
+       monotonic and thread CPU-time clocks in nanoseconds, otherwise none. */
+    void resetTimingClocks() noexcept;
+
+    /* Gets the clocks currently used to time tests. */
+    void getTimingClocks(TimingClock& wallClock, TimingClock& cpuClock) noexcept;
+
+    /* The time taken by a phase of a test, in clock ticks. */
+    struct TestDuration
+    {
+        unsigned long long wallTime; // Elapsed time on the wall clock
+        unsigned long long cpuTime;  // Elapsed time on the CPU-time clock
+    };
+
+    /* The times taken by each phase of a test. */
+    struct TestTimings
+    {
+        TestDuration setUp;
+        TestDuration testBody;
+        TestDuration tearDown;
+
+        /* Gets the total time taken by the test. */
+        inline TestDuration total() const noexcept
+        {
+            return TestDuration{setUp.wallTime + testBody.wallTime + tearDown.wallTime,
+                setUp.cpuTime + testBody.cpuTime + tearDown.cpuTime};
+        }
+    };
+
+    /* Heap allocations made through the global 'operator new' by a test body, on
+       the thread running the test. Allocations made by ostest itself (such as
+       '_ALL' assertions) are not included. */
+    struct AllocationStats
+    {
+        unsigned long long allocations;   // The number of allocations
+        unsigned long long deallocations; // The number of deallocations
+        unsigned long long bytes;         // The total number of bytes allocated
+        unsigned long long peakBytes;     // The most bytes allocated and not yet deallocated at once
+    };
+
+    /* A performance counter. The software counters are measured instead of the
+       hardware counters where the hardware counters are not permitted. */
+    enum class PerfCounter : unsigned char
+    {
+        Cycles, Instructions, BranchMisses, CacheMisses,
+        TaskClock, PageFaults, ContextSwitches
+    };
+
+    /* Performance counters read around a test body, on the thread running the
+       test. For benchmarks, every iteration (including warm-up) is counted. */
+    struct PerfCounters
+    {
+        unsigned long long cycles;          // CPU cycles
+        unsigned long long instructions;    // Instructions retired
+        unsigned long long branchMisses;    // Mispredicted branches
+        unsigned long long cacheMisses;     // Last-level cache misses
+        unsigned long long taskClock;       // Time spent on the CPU, in nanoseconds
+        unsigned long long pageFaults;      // Page faults
+        unsigned long long contextSwitches; // Context switches
+        unsigned int measured;              // Bit mask of the counters measured
+
+        /* Returns true if the given counter was measured. */
+        inline bool has(PerfCounter counter) const noexcept {
+            return (measured >> static_cast<unsigned int>(counter) & 1) != 0;
+        }
+
+        /* Gets the instructions retired per cycle, or zero if not measured. */
+        inline double instructionsPerCycle() const noexcept {
+            return has(PerfCounter::Cycles) && has(PerfCounter::Instructions) && cycles != 0 ?
+                static_cast<double>(instructions) / static_cast<double>(cycles) : 0.0;
+        }
+    };
+
+    /* Statistics gathered by a benchmark. Times are per iteration, in wall clock ticks. */
+    struct BenchmarkStats
+    {
+        unsigned long long iterations; // The number of iterations in each sample
+        unsigned int samples;          // The number of samples taken
+        double mean;                   // The mean time per iteration
+        double median;                 // The median time per iteration
+        double p99;                    // The 99th percentile time per iteration
+        double stddev;                 // The standard deviation of the time per iteration
+        double opsPerSecond;           // Iterations per second, assuming a nanosecond clock
+    };
+
+    /* Determines which temporary ('_ALL') assertions are recorded once the assertion
+       pool is full. Only used when built with OSTEST_NO_ALLOC, in which case
+       temporary assertions are stored in a pool of OSTEST_ASSERTION_POOL_SIZE slots.
+       A test still fails if an assertion which was not recorded fails. */
+    enum class AssertionPoolPolicy
+    {
+        KeepFirst,      // Later assertions are not recorded
+        KeepFailures,   // Later assertions replace passed assertions of the same test
+        DropWithCounter // Later assertions are not recorded, but are counted
+    };
+
+    /* Sets the policy used when the assertion pool is full. */
+    void setAssertionPoolPolicy(AssertionPoolPolicy policy) noexcept;
+
+    /* Gets the policy used when the assertion pool is full. */
+    AssertionPoolPolicy getAssertionPoolPolicy() noexcept;
+
+    /* Determines which temporary ('_ALL') assertions a test's result keeps once they
+       pass. Under the restricted policies, passing temporary assertions are released
+       as soon as they are made (or once more recent passes are kept), so that long
+       running tests need not hold every assertion. Released assertions are still
+       counted by 'getPassCount', and by 'getReleasedAssertions'. Failures, and
+       assertions made once per call site, are always kept. */
+    enum class RetentionPolicy : unsigned char
+    {
+        KeepAll,        // Every assertion is kept
+        KeepFailures,   // Only failed temporary assertions are kept
+        KeepLastPasses  // Failed temporary assertions are kept, as are the most recent passes
+    };
+
+    /* Sets the retention policy given to each new 'TestRunner', and the number of
+       passes kept with 'RetentionPolicy::KeepLastPasses'. */
+    void setRetentionPolicy(RetentionPolicy policy, unsigned int lastPasses = 0) noexcept;
+
+    /* Gets the retention policy given to each new 'TestRunner'. */
+    RetentionPolicy getRetentionPolicy() noexcept;
+
+    /* Gets the number of passes kept with 'RetentionPolicy::KeepLastPasses'. */
+    unsigned int getRetainedPasses() noexcept;
+
+
     /* Object holding the result data for a test. */
     class TestResult : private ::_ostest_internal::_LinkedList<Assertion>
     {
         friend class Assertion;
+        friend class UnitTest;
+        friend class TestRunner;
 
     private:
-        unsigned int* refCount = nullptr;
+        _ostest_internal::_ResultData* shared = nullptr;
+        TestTimings timings{};
+        BenchmarkStats benchmarkStats{};
+        AllocationStats allocationStats{};
+        bool allocationsTracked = false;
+        PerfCounters perfCounters{};
+        _ostest_internal::_ResultSummary summary{};
 
     public:
         TestResult();
@@ -324,25 +860,117 @@ namespace ostest
         TestResult& operator=(TestResult&& other);
 
         /* Returns true if the test succeeded. False otherwise. */
-        bool succeeded() const;
+        inline bool succeeded() const noexcept {
+            return summary.failCount == 0 && !summary.droppedFailure;
+        }
 
         /* Gets the first assertion/expectation to fail, or nullptr if none. */
-        const Assertion* getFirstFailure() const;
+        inline const Assertion* getFirstFailure() const noexcept {
+            return summary.firstFailure;
+        }
 
         /* Gets the final assertion/expectation to fail, or nullptr if none. */
-        const Assertion* getFinalFailure() const;
+        inline const Assertion* getFinalFailure() const noexcept {
+            return summary.finalFailure;
+        }
+
+        /* Gets the number of recorded assertions/expectations which passed. */
+        inline unsigned int getPassCount() const noexcept {
+            return summary.passCount;
+        }
+
+        /* Gets the number of recorded assertions/expectations which failed. */
+        inline unsigned int getFailureCount() const noexcept {
+            return summary.failCount;
+        }
 
         /* Gets the assertions and expectations made by the test. */
         inline AssertionIterator getAssertions() const {
             return AssertionIterator(this->firstItem);
         }
+
+        /* Gets the time taken by each phase of the test. */
+        inline const TestTimings& getTimings() const noexcept {
+            return timings;
+        }
+        /* [internal] Sets the time taken by each phase of the test. */
+        inline void setTimings(const TestTimings& timings) noexcept {
+            this->timings = timings;
+        }
+
+        /* Gets the statistics gathered by a benchmark, or nullptr if the test
+           was not a benchmark or could not be measured. */
+        inline const BenchmarkStats* getBenchmarkStats() const noexcept {
+            return benchmarkStats.samples != 0 ? &benchmarkStats : nullptr;
+        }
+        /* [internal] Sets the statistics gathered by a benchmark. */
+        inline void setBenchmarkStats(const BenchmarkStats& stats) noexcept {
+            this->benchmarkStats = stats;
+        }
+
+        /* Gets the heap allocations made by the test body, or nullptr if they were
+           not tracked. Tracked when ostest is compiled with 'OSTEST_TRACK_ALLOCATIONS'. */
+        inline const AllocationStats* getAllocationStats() const noexcept {
+            return allocationsTracked ? &allocationStats : nullptr;
+        }
+        /* [internal] Sets the heap allocations made by the test body. */
+        inline void setAllocationStats(const AllocationStats& stats) noexcept
+        {
+            this->allocationStats = stats;
+            this->allocationsTracked = true;
+        }
+
+        /* Gets the performance counters read around the test body, or nullptr if none
+           could be read. Read when ostest is compiled with 'OSTEST_PERF_COUNTERS'. */
+        inline const PerfCounters* getPerfCounters() const noexcept {
+            return perfCounters.measured != 0 ? &perfCounters : nullptr;
+        }
+        /* [internal] Sets the performance counters read around the test body. */
+        inline void setPerfCounters(const PerfCounters& counters) noexcept {
+            this->perfCounters = counters;
+        }
         /* Returns true if the test succeeded. False otherwise. */
         inline operator bool() const {
             return succeeded();
         }
 
+        /* Gets the number of assertions which were not recorded as the assertion
+           pool was full. Only counted with 'AssertionPoolPolicy::DropWithCounter'. */
+        inline unsigned int getDroppedAssertions() const noexcept {
+            return summary.droppedCount;
+        }
+
+        /* Gets the number of passing temporary assertions which were released
+           under the retention policy of the test's runner. */
+        inline unsigned int getReleasedAssertions() const noexcept {
+            return summary.releasedCount;
+        }
+
     private:
         void destroy();
+
+        /* Releases a passing temporary assertion, no longer in the list. */
+        void release(Assertion& assertion);
+
+        /* Keeps the given passing temporary assertion, already in the list,
+           should the retention policy allow. */
+        void retainPass(Assertion& assertion);
+
+        /* Allocates storage from the result's arena. */
+        void* allocate(_ostest_internal::size_t size, _ostest_internal::size_t align);
+
+#if OSTEST_STD_THREADS
+        /* Returns true if the test is running on a thread other than the calling thread. */
+        bool isForeignThread() const noexcept;
+
+        /* Marks the test as running on the calling thread. Assertions made on other
+           threads are then queued, until recorded by 'endThreads'. */
+        void beginThreads() noexcept;
+        void endThreads();
+
+        /* Queues an assertion made on another thread. */
+        bool addForeign(Assertion& assertion, bool result);
+#endif
     };
 
 
@@ -351,28 +979,51 @@ namespace ostest
     private:
         TestSuite& suite;
         const TestInfo& info;
+        void* storage{};
+        RetentionPolicy retention = getRetentionPolicy();
+        unsigned int lastPasses = getRetainedPasses();
 
     public:
         TestRunner(TestSuite& suite, const TestInfo& info)
             : suite(suite), info(info) { }
 
+        /* Creates a runner which constructs the test instance within the given
+           storage rather than the test's own. The storage must be at least
+           'TestInfo::instanceSize()' bytes, aligned to 'TestInfo::instanceAlign()'. */
+        TestRunner(TestSuite& suite, const TestInfo& info, void* storage)
+            : suite(suite), info(info), storage(storage) { }
+
         virtual ~TestRunner() = default;
 
     public:
         virtual TestResult run();
+
+        /* Sets which passing temporary assertions the result of the test keeps,
+           overriding the policy given by 'setRetentionPolicy'. */
+        inline void setRetentionPolicy(RetentionPolicy policy, unsigned int lastPasses = 0) noexcept
+        {
+            this->retention = policy;
+            this->lastPasses = lastPasses;
+        }
+
+    protected:
+        friend _ostest_internal::_Watch;
+
+        /* Called once the test has completed. Calls 'handleTestComplete' by default,
+           or queues the test on the active 'AsyncReporter' should one exist. */
+        virtual void notifyComplete(const TestInfo& info, const TestResult& result);
     };
 
     class UnitTest
     {
         friend Assertion;
         friend TestRunner;
+        friend Benchmark;
         friend _ostest_internal::_MetadataItem;
 
     private:
         TestResult result{};
         const TestInfo* info{};
-        mutable _ostest_internal::_MetadataItem* firstUserMetadataItem{};
-        mutable _ostest_internal::_MetadataItem* firstInternalMetadataItem{};
 
     protected:
         /* Creates (but does not register) a new Unit Test. */
@@ -384,6 +1035,15 @@ namespace ostest
         /* The Unit Test body. */
         virtual void testBody() = 0;
 
+    protected:
+        /* [internal] Allocates storage for a temporary assertion. The storage is
+           released once the final copy of the test's result is destroyed. */
+        inline void* allocateTemporary(_ostest_internal::size_t size,
+            _ostest_internal::size_t align)
+        {
+            return result.allocate(size, align);
+        }
+
     public:
         /* Gets TestInfo for the current Unit Test. */
         inline const TestInfo& getInfo() const noexcept { return *info; }
@@ -391,23 +1051,27 @@ namespace ostest
         /* Gets the current TestResult for the current Unit Test. */
         inline const TestResult& getResult() const noexcept { return result; }
 
-        /* Gets the metadata with the given name, or returns nullptr if none exists. */
+        /* Gets the metadata with the given name, or returns nullptr if none exists.
+           The name is given by 'OSTEST_METADATA_NAME'. */
         template<typename T>
-        Metadata<T>* getMetadata(const char* name) {
-            return reinterpret_cast<Metadata<T>*>(getMetadataRaw(name));
+        Metadata<T>* getMetadata(const _ostest_internal::_MetadataName& name) {
+            return reinterpret_cast<Metadata<T>*>(getMetadataRaw(name.name, name.hash));
         }
-        /* Gets the metadata with the given name, or returns nullptr if none exists. */
+        /* Gets the metadata with the given name, or returns nullptr if none exists.
+           The name is given by 'OSTEST_METADATA_NAME'. */
         template<typename T>
-        const Metadata<T>* getMetadata(const char* name) const {
-            return reinterpret_cast<Metadata<T>*>(getMetadataRaw(name));
+        const Metadata<T>* getMetadata(const _ostest_internal::_MetadataName& name) const {
+            return reinterpret_cast<Metadata<T>*>(getMetadataRaw(name.name, name.hash));
         }
 
     private:
-        void addMetadata(_ostest_internal::_MetadataItem& item, bool user=true);
-        void* getMetadataRaw(const char* name, bool user = true) const;
-        void removeMetadata(_ostest_internal::_MetadataItem& item, bool user = true);
+        void* getMetadataRaw(const char* name, unsigned int hash) const;
     };
 
+    inline bool Assertion::isRecordedIn(const UnitTest& test) const noexcept {
+        return owner == test.result.summary.serial;
+    }
+
     /* Object representing Test Suites. */
     class TestSuite
     {
@@ -439,6 +1103,12 @@ namespace ostest
         virtual bool hasInstance() noexcept = 0;
         virtual UnitTest& newInstance(TestSuite&) = 0;
         virtual void deleteInstance() = 0;
+
+        /* Constructs a new instance within the given storage. The instance
+           is destroyed via its virtual destructor. */
+        virtual UnitTest& newInstance(TestSuite&, void* where) = 0;
+        virtual _ostest_internal::size_t instanceSize() const noexcept = 0;
+        virtual _ostest_internal::size_t instanceAlign() const noexcept = 0;
     };
 
     class SuiteUniquePtr
@@ -484,6 +1154,8 @@ namespace ostest
         friend SuiteIterator;
         friend _ostest_internal::_LinkedListIterator<SuiteInfo>;
         friend SuiteIterator getSuites() noexcept;
+        template<typename T>
+        friend struct _ostest_internal::_SuiteRegistration;
 
         using ctor = TestSuite& (*)(void*);
         using dtor = void (*)(void*);
@@ -491,14 +1163,30 @@ namespace ostest
         void* ptr{};
         ctor constructor{};
         dtor destructor{};
+        _ostest_internal::size_t size{};
+        _ostest_internal::size_t align{};
 
         _ostest_internal::_LinkedList<TestInfo> _tests{};
 
     public:
+#if OSTEST_SECTION_REGISTRATION
+        const char* name{}; // Set when the suite's first test is registered
+#else
         const char* const name{};
+#endif
 
     private:
-        SuiteInfo(void* ptr, ctor constructor, dtor destructor, const char* name);
+        SuiteInfo(void* ptr, ctor constructor, dtor destructor,
+            _ostest_internal::size_t size, _ostest_internal::size_t align, const char* name);
+
+        /* Creates a new SuiteInfo instance, registered along with its first test. */
+        constexpr SuiteInfo(void* ptr, ctor constructor, dtor destructor,
+            _ostest_internal::size_t size, _ostest_internal::size_t align)
+            : ptr(ptr), constructor(constructor), destructor(destructor),
+              size(size), align(align) { }
+
+        /* Adds the suite to the end of the list of suites. */
+        void registerSuite() noexcept;
 
         TestSuite& construct() {
             return constructor(ptr);
@@ -516,6 +1204,21 @@ namespace ostest
             return TestIterator(_tests.firstItem);
         }
 
+        /* [internal] Constructs a new suite instance within the given storage.
+           Used where more than one instance of a suite must exist at once. */
+        TestSuite& newInstance(void* where) const {
+            return constructor(where);
+        }
+        /* [internal] Destroys a suite instance created with 'newInstance'. */
+        void deleteInstance(void* where) const {
+            return destructor(where);
+        }
+
+        /* Gets the size in bytes of an instance of the suite. */
+        _ostest_internal::size_t instanceSize() const noexcept { return size; }
+        /* Gets the alignment in bytes of an instance of the suite. */
+        _ostest_internal::size_t instanceAlign() const noexcept { return align; }
+
     public:
         template<typename T>
         static SuiteInfo& registerNew(const char* name) noexcept
@@ -526,7 +1229,7 @@ namespace ostest
                 data,
                 [](void* ptr) -> TestSuite& { return *(new (ptr) T()); },
                 [](void* ptr) { reinterpret_cast<T*>(ptr)->T::~T(); },
-                name);
+                sizeof(T), alignof(T), name);
 
             return info;
         }
@@ -537,13 +1240,28 @@ namespace ostest
     {
         friend TestIterator;
         friend TestRunner;
+        friend UnitTest;
+        friend _ostest_internal::_MetadataItem;
         friend _ostest_internal::_LinkedList<TestInfo>;
         friend _ostest_internal::_LinkedListIterator<TestInfo>;
         friend _ostest_internal::_LinkedListIterator<const TestInfo>;
+        friend SuiteIterator getSuites() noexcept;
 
     private:
         ::ostest::UnitTestWrapper& wrapper;
-        TestInfo* nextItem;
+        mutable TestInfo* nextItem{};
+        bool benchmark;
+#if OSTEST_SECTION_REGISTRATION
+        const char* suiteName;
+#endif
+
+        // Metadata is held here rather than on the test instance so that it is
+        // shared by every instance of the test. Each item is unlinked when it is
+        // destroyed - on exit for static items, or as the test body returns otherwise.
+        mutable _ostest_internal::_MetadataItem* firstUserMetadataItem{};
+        mutable _ostest_internal::_MetadataItem* finalUserMetadataItem{};
+        mutable _ostest_internal::_MetadataItem* firstInternalMetadataItem{};
+        mutable _ostest_internal::_MetadataItem* finalInternalMetadataItem{};
 
     public:
         const int line;         // The line of the test definition.
@@ -555,32 +1273,80 @@ namespace ostest
         /* Creates and registers a new TestInfo instance. */
         TestInfo(SuiteInfo& suite, const char* name,
             ::ostest::UnitTestWrapper& wrapper,
-            const char* file, int line);
+            const char* file, int line, bool benchmark);
 
     public:
+#if OSTEST_SECTION_REGISTRATION
+        /* [internal] Creates a constant-initialized TestInfo instance. The test is
+           registered with its suite when 'getSuites' is first called. */
+        constexpr TestInfo(_ostest_internal::_constinit_tag, SuiteInfo& suite,
+            const char* suiteName, const char* name, ::ostest::UnitTestWrapper& wrapper,
+            const char* file, int line, bool benchmark)
+            : wrapper(wrapper), benchmark(benchmark), suiteName(suiteName),
+              line(line), suite(suite), name(name), file(file) { }
+#endif
+
         // Default move constructor
         TestInfo(TestInfo&& move) noexcept = default;
         // Default copy constructor
         TestInfo(const TestInfo& copy) noexcept = default;
 
-        /* Gets the metadata with the given name, or returns nullptr if none exists. */
+        /* Gets the metadata with the given name, or returns nullptr if none exists.
+           The name is given by 'OSTEST_METADATA_NAME'. */
         template<typename T>
-        const Metadata<T>* getMetadata(const char* name) const {
-            return wrapper.getInstance().getMetadata<T>(name);
+        const Metadata<T>* getMetadata(const _ostest_internal::_MetadataName& name) const {
+            return reinterpret_cast<Metadata<T>*>(getMetadataRaw(name.name, name.hash));
         }
 
+        /* Returns true if the test is a benchmark. False otherwise. */
+        inline bool isBenchmark() const noexcept { return benchmark; }
+
+        /* Gets the size in bytes of an instance of the test. */
+        _ostest_internal::size_t instanceSize() const noexcept {
+            return wrapper.instanceSize();
+        }
+        /* Gets the alignment in bytes of an instance of the test. */
+        _ostest_internal::size_t instanceAlign() const noexcept {
+            return wrapper.instanceAlign();
+        }
+
+    private:
+        void addMetadata(_ostest_internal::_MetadataItem& item, bool user = true) const;
+        void* getMetadataRaw(const char* name, unsigned int hash, bool user = true) const;
+        void removeMetadata(_ostest_internal::_MetadataItem& item, bool user = true) const;
+
     public:
         /* Creates and registers a new unit test with the given details.
            Returns the new test's test info.
         */
         static TestInfo registerNew(SuiteInfo& suite, const char* name,
-            UnitTestWrapper& wrapper, const char* file, int line);
+            UnitTestWrapper& wrapper, const char* file, int line, bool benchmark = false);
     };
 }
 
 
 namespace _ostest_internal
 {
+    template<typename T>
+    struct _SuiteRegistration
+    {
+        alignas(alignof(T)) static char data[sizeof(T)];
+        static ::ostest::SuiteInfo info;
+
+        static ::ostest::TestSuite& construct(void* ptr) {
+            return *(new (ptr) T());
+        }
+        static void destruct(void* ptr) {
+            reinterpret_cast<T*>(ptr)->T::~T();
+        }
+    };
+
+    template<typename T>
+    alignas(alignof(T)) char _SuiteRegistration<T>::data[sizeof(T)];
+    template<typename T>
+    ::ostest::SuiteInfo _SuiteRegistration<T>::info{data, &construct, &destruct, sizeof(T), alignof(T)};
+
+
     template<typename T>
     class _InstanceWrapper : public ::ostest::UnitTestWrapper
     {
@@ -590,7 +1356,11 @@ namespace _ostest_internal
     public:
         _InstanceWrapper() = default;
         _InstanceWrapper(const _InstanceWrapper&) = delete;
+#if !OSTEST_SECTION_REGISTRATION
+        // (Omitted when tests are constant-initialized, as instances are deleted after
+        // each run, and this would require a global destructor to be registered.)
         ~_InstanceWrapper() { deleteInstance(); }
+#endif
 
     protected:
         T& getInstance() override final {
@@ -609,7 +1379,20 @@ namespace _ostest_internal
         }
 
         void deleteInstance() override final {
-            if (_ptr != nullptr) return _ptr->T::~T();
+            if (_ptr != nullptr) _ptr->T::~T();
+            _ptr = nullptr;
+        }
+
+        T& newInstance(ostest::TestSuite& suite, void* where) override final {
+            return *(new (where) T(suite));
+        }
+
+        size_t instanceSize() const noexcept override final {
+            return sizeof(T);
+        }
+
+        size_t instanceAlign() const noexcept override final {
+            return alignof(T);
         }
     };
 }
@@ -622,32 +1405,59 @@ namespace _ostest_internal
 #define _OSTEST_NS _tests
 
 
-/* [internal] Creates a new OSTest Unit Test. */
-#define _OSTEST_INTERNAL(suiteClass, suiteName, testName) \
+#if OSTEST_SECTION_REGISTRATION
+/* [internal] Declares the pointer to the test's info placed in the test section. */
+#define _OSTEST_REGISTRATION_DECL static const ::ostest::TestInfo* const _registration;
+
+/* [internal] Defines the test's constant-initialized info, and places a pointer to it
+   in the 'ostest_tests' section, from which 'getSuites' finds every test. */
+#define _OSTEST_REGISTRATION_DEF(cls, isBenchmark, suiteClass, suiteName, testName) \
+    const ::ostest::TestInfo cls::info{::_ostest_internal::_constinit_tag{}, \
+        ::_ostest_internal::_SuiteRegistration<suiteClass>::info, #suiteName, #testName, \
+        static_cast<::ostest::UnitTestWrapper&>(cls::_wrapper), __FILE__, __LINE__, isBenchmark}; \
+    __attribute__((section("ostest_tests"), used)) \
+    const ::ostest::TestInfo* const cls::_registration = &cls::info;
+#else
+#define _OSTEST_REGISTRATION_DECL
+
+/* [internal] Defines the test's info, registering the test upon initialisation. */
+#define _OSTEST_REGISTRATION_DEF(cls, isBenchmark, suiteClass, suiteName, testName) \
+    const ::ostest::TestInfo cls::info = ::ostest::TestInfo::registerNew( \
+        ::ostest::SuiteInfo::registerNew<suiteClass>(#suiteName), \
+        #testName, static_cast<::ostest::UnitTestWrapper&>(cls::_wrapper), \
+        __FILE__, __LINE__, isBenchmark);
+#endif
+
+/* [internal] Creates a new OSTest Unit Test of the given base class, whose body is
+   defined by the given method. */
+#define _OSTEST_INTERNAL_EX(baseClass, bodyName, isBenchmark, suiteClass, suiteName, testName) \
     namespace _OSTEST_NS { \
-        class _OSTEST_CLS_NAME(suiteName, testName) : public ::ostest::UnitTest \
+        class _OSTEST_CLS_NAME(suiteName, testName) : public baseClass \
         { \
             friend class ::ostest::TestRunner; \
         private: \
             static const ostest::TestInfo info; \
             static ::_ostest_internal::_InstanceWrapper<_OSTEST_NS::_OSTEST_CLS_NAME(suiteName, testName)> _wrapper; \
+            _OSTEST_REGISTRATION_DECL \
         public: \
             inline _OSTEST_CLS_NAME(suiteName, testName)(::ostest::TestSuite& suite) noexcept \
-                : ::ostest::UnitTest(info), suite(reinterpret_cast<suiteClass&>(suite)) { } \
+                : baseClass(info), suite(reinterpret_cast<suiteClass&>(suite)) { } \
             inline void* operator new(::_ostest_internal::size_t, void* where) noexcept { return where; } \
         protected: \
             suiteClass& suite; \
-            void testBody() override final; \
+            void bodyName() override final; \
         }; \
     } \
     ::_ostest_internal::_InstanceWrapper<_OSTEST_NS::_OSTEST_CLS_NAME(suiteName, testName)> _OSTEST_NS::_OSTEST_CLS_NAME(suiteName, testName)::_wrapper{}; \
     \
-    const ::ostest::TestInfo _OSTEST_NS::_OSTEST_CLS_NAME(suiteName, testName)::info = ::ostest::TestInfo::registerNew( \
-        ::ostest::SuiteInfo::registerNew<suiteClass>(#suiteName), \
-        #testName, static_cast<::ostest::UnitTestWrapper&>(_OSTEST_NS::_OSTEST_CLS_NAME(suiteName, testName)::_wrapper), \
-        __FILE__, __LINE__); \
+    _OSTEST_REGISTRATION_DEF(_OSTEST_NS::_OSTEST_CLS_NAME(suiteName, testName), \
+        isBenchmark, suiteClass, suiteName, testName) \
     \
-    void _OSTEST_NS::_OSTEST_CLS_NAME(suiteName, testName)::testBody()
+    void _OSTEST_NS::_OSTEST_CLS_NAME(suiteName, testName)::bodyName()
+
+/* [internal] Creates a new OSTest Unit Test. */
+#define _OSTEST_INTERNAL(suiteClass, suiteName, testName) \
+    _OSTEST_INTERNAL_EX(::ostest::UnitTest, testBody, false, suiteClass, suiteName, testName)
 
 
 
@@ -660,10 +1470,16 @@ namespace _ostest_internal
 /* Creates a new OSTest Test Suite with empty setUp/tearDown. */
 #define OSTEST_TEST_SUITE(suiteName) class suiteName : public ::ostest::TestSuite { };
 
+/* Names an item of metadata, hashing the given string literal at compile time. */
+#define OSTEST_METADATA_NAME(name) (::_ostest_internal::_MetadataName{(name), \
+    ::_ostest_internal::_hashConstant< ::_ostest_internal::_hashName(name)>::value})
+
 
 #if !OSTEST_MUST_PREFIX
 #define TEST(suiteName, testName) OSTEST_TEST(suiteName, testName)
 #define TEST_EX(suiteNamespace, suiteName, testName) OSTEST_TEST_EX(suiteNamespace, suiteName, testName)
 
 #define TEST_SUITE(suiteName) OSTEST_TEST_SUITE(suiteName)
+
+#define METADATA_NAME(name) OSTEST_METADATA_NAME(name)
 #endif
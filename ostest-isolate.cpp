@@ -0,0 +1,405 @@
+/* ostest-isolate.cpp - (c) 2018 James Renwick */
+#include "ostest.hpp"
+
+#if OSTEST_POSIX
+#if OSTEST_NO_ALLOC
+#error Process isolation requires allocation: cannot compile with both OSTEST_POSIX and OSTEST_NO_ALLOC.
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#if OSTEST_STD_THREADS
+#include <mutex>
+#endif
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+    // Assertion rebuilt from a result received from a child process.
+    // Expressions and file names are string literals, so remain valid in the
+    // parent; only the message is copied.
+    class _IsolatedAssertion : public CustomAssertion
+    {
+    private:
+        std::unique_ptr<char[]> text;
+
+    public:
+        _IsolatedAssertion(const char* expression, const char* file, int line,
+            const char* message, size_t messageLength)
+            : CustomAssertion(&getText, &destroy, expression, _heapalloc_tag{}, file, line, true),
+              text(new char[messageLength + 1])
+        {
+            std::memcpy(this->text.get(), message, messageLength);
+            this->text[messageLength] = '\0';
+        }
+
+    private:
+        static const char* getText(const CustomAssertion& assertion) {
+            return static_cast<const _IsolatedAssertion&>(assertion).text.get();
+        }
+        static void destroy(CustomAssertion* assertion) {
+            delete static_cast<_IsolatedAssertion*>(assertion);
+        }
+    };
+
+    // Writes the whole buffer to the given file descriptor.
+    static bool _writeAll(int fd, const char* data, size_t length)
+    {
+        while (length > 0)
+        {
+            ssize_t written = ::write(fd, data, length);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return false;
+            data += written;
+            length -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    template<typename T>
+    static void _append(std::string& buffer, const T& value) {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    static T _read(const char*& data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(value));
+        data += sizeof(value);
+        return value;
+    }
+
+#if OSTEST_STD_THREADS
+    // Frames are written by both the test and the watchdog thread of a child process
+    static std::mutex _childLock{};
+    static const TestInfo* _childTest = nullptr; // Guarded by '_childLock'
+    static int _childFd = -1;
+#endif
+
+    // Runner used within a child process to send results to the parent.
+    class _ChildRunner : public TestRunner
+    {
+    private:
+        int fd;
+
+    public:
+        _ChildRunner(TestSuite& suite, const TestInfo& info, int fd)
+            : TestRunner(suite, info), fd(fd)
+        {
+#if OSTEST_STD_THREADS
+            std::lock_guard<std::mutex> guard(_childLock);
+            _childTest = &info;
+#endif
+        }
+
+    protected:
+        void notifyComplete(const TestInfo&, const TestResult& result) override
+        {
+            // Frame: [length][timings][benchmark][tracked][allocations][perf][assertion count]([passed][line][expr][file][msg length][msg])*
+            std::string frame(sizeof(std::uint32_t), '\0');
+            std::uint32_t count = 0;
+            for (auto& _ : result.getAssertions()) { (void)_; count++; }
+            _append(frame, result.getTimings());
+            _append(frame, result.getBenchmarkStats() ? *result.getBenchmarkStats() : BenchmarkStats{});
+            _append(frame, static_cast<std::uint8_t>(result.getAllocationStats() != nullptr));
+            _append(frame, result.getAllocationStats() ? *result.getAllocationStats() : AllocationStats{});
+            _append(frame, result.getPerfCounters() ? *result.getPerfCounters() : PerfCounters{});
+            _append(frame, count);
+
+            for (auto& assertion : result.getAssertions())
+            {
+                const char* message = assertion.getMessage();
+                auto length = static_cast<std::uint32_t>(message ? std::strlen(message) : 0);
+
+                _append(frame, static_cast<std::uint8_t>(assertion.passed()));
+                _append(frame, static_cast<std::int32_t>(assertion.line));
+                _append(frame, assertion.expression);
+                _append(frame, assertion.file);
+                _append(frame, length);
+                frame.append(message ? message : "", length);
+            }
+            auto size = static_cast<std::uint32_t>(frame.size() - sizeof(std::uint32_t));
+            std::memcpy(&frame[0], &size, sizeof(size));
+
+#if OSTEST_STD_THREADS
+            std::lock_guard<std::mutex> guard(_childLock);
+            _childTest = nullptr;
+#endif
+            if (!_writeAll(fd, frame.data(), frame.size())) ::_exit(2);
+        }
+    };
+
+#if OSTEST_STD_THREADS
+    // Frame sent in place of a result when the running test exceeds its timeout
+    static constexpr std::uint32_t _timeoutFrame = 0;
+
+    static void _childTimeout(const TestInfo& info)
+    {
+        // The test may have completed since its timeout elapsed
+        std::lock_guard<std::mutex> guard(_childLock);
+        if (_childTest != &info) return;
+
+        _writeAll(_childFd, reinterpret_cast<const char*>(&_timeoutFrame), sizeof(_timeoutFrame));
+        ::_exit(1);
+    }
+#endif
+
+    // Runs the given tests sequentially within a child process.
+    static void _runChild(const TestInfo* const* tests, const std::vector<size_t>& batch, int fd)
+    {
+#if OSTEST_STD_THREADS
+        // The parent reports the timeout, then continues with the remaining tests
+        _childFd = fd;
+        _resetWatchdog(&_childTimeout);
+#endif
+        const SuiteInfo* currentSuite = nullptr;
+        std::unique_ptr<char[]> suiteData{};
+        void* suiteStorage = nullptr;
+        TestSuite* suite = nullptr;
+
+        for (size_t index : batch)
+        {
+            const TestInfo& test = *tests[index];
+
+            if (&test.suite != currentSuite)
+            {
+                if (currentSuite != nullptr) currentSuite->deleteInstance(suiteStorage);
+                currentSuite = &test.suite;
+
+                size_t align = currentSuite->instanceAlign();
+                suiteData.reset(new char[currentSuite->instanceSize() + align]);
+                auto address = reinterpret_cast<std::uintptr_t>(suiteData.get());
+                suiteStorage = reinterpret_cast<void*>((address + align - 1) & ~(align - 1));
+                suite = &currentSuite->newInstance(suiteStorage);
+            }
+            _ChildRunner(*suite, test, fd).run();
+        }
+        if (currentSuite != nullptr) currentSuite->deleteInstance(suiteStorage);
+    }
+
+    // State held by the parent for each running child.
+    struct _Child
+    {
+        pid_t pid = -1;
+        int fd = -1;
+        std::vector<size_t> batch{};
+        size_t completed = 0;
+        bool timedOut = false; // Whether the child ended the test being run
+        std::string buffer{};
+    };
+}
+
+namespace ostest
+{
+    using namespace ::_ostest_internal;
+
+    IsolatedRunner::IsolatedRunner(unsigned int processCount, size_t batchSize) noexcept
+        : processCount(processCount), batchSize(batchSize)
+    {
+        if (this->processCount == 0) {
+            long cpus = ::sysconf(_SC_NPROCESSORS_ONLN);
+            this->processCount = cpus > 0 ? static_cast<unsigned int>(cpus) : 1;
+        }
+        if (this->batchSize == 0) this->batchSize = 1;
+    }
+
+    void IsolatedRunner::run()
+    {
+        size_t count;
+        auto tests = _getAllTests(count);
+        run(tests, count);
+        delete[] tests;
+    }
+
+    void IsolatedRunner::notifyComplete(const TestInfo& info, const TestResult& result)
+    {
+#if OSTEST_STD_THREADS
+        if (auto reporter = AsyncReporter::getActive()) return reporter->push(info, result);
+#endif
+        ::ostest::handleTestComplete(info, result);
+    }
+
+    void IsolatedRunner::run(const TestInfo* const* tests, size_t count)
+    {
+        std::deque<std::vector<size_t>> pending{};
+        std::vector<_Child> children{};
+
+        for (size_t i = 0; i < count; i += batchSize)
+        {
+            std::vector<size_t> batch{};
+            for (size_t j = i; j < count && j < i + batchSize; j++) batch.push_back(j);
+            pending.push_back(std::move(batch));
+        }
+
+        while (!pending.empty() || !children.empty())
+        {
+            // Start children until the pool is full
+            int startError = 0;
+            while (!pending.empty() && children.size() < processCount)
+            {
+                int fds[2];
+                if (::pipe(fds) != 0) { startError = errno; break; }
+
+                // Prevent buffered output being written by both processes
+                std::fflush(nullptr);
+
+                pid_t pid = ::fork();
+                if (pid == 0)
+                {
+                    ::close(fds[0]);
+                    _runChild(tests, pending.front(), fds[1]);
+                    std::fflush(nullptr);
+                    ::_exit(0);
+                }
+                ::close(fds[1]);
+                if (pid < 0) { startError = errno; ::close(fds[0]); break; }
+
+                _Child child{};
+                child.pid = pid;
+                child.fd = fds[0];
+                child.batch = std::move(pending.front());
+                pending.pop_front();
+                children.push_back(std::move(child));
+            }
+            if (children.empty())
+            {
+                // Unable to start any child, so report the remaining tests as failed
+                char message[128];
+                std::snprintf(message, sizeof(message),
+                    "Could not start a child process to run the test: %s.", std::strerror(startError));
+
+                for (auto& batch : pending)
+                {
+                    for (size_t index : batch)
+                    {
+                        const TestInfo& test = *tests[index];
+                        TestResult result{};
+                        (new _IsolatedAssertion("<process not started>", test.file, test.line,
+                            message, std::strlen(message)))->evaluate(result, false);
+                        notifyComplete(test, result);
+                    }
+                }
+                break;
+            }
+
+            std::vector<pollfd> fds(children.size());
+            for (size_t i = 0; i < children.size(); i++) {
+                fds[i].fd = children[i].fd;
+                fds[i].events = POLLIN;
+                fds[i].revents = 0;
+            }
+            if (::poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) break;
+
+            for (size_t i = children.size(); i-- > 0;)
+            {
+                if (fds[i].revents == 0) continue;
+                _Child& child = children[i];
+
+                char data[65536];
+                ssize_t length = ::read(child.fd, data, sizeof(data));
+                if (length < 0 && errno == EINTR) continue;
+                if (length > 0) child.buffer.append(data, static_cast<size_t>(length));
+
+                // Rebuild the results of each complete frame
+                while (child.buffer.size() >= sizeof(std::uint32_t))
+                {
+                    const char* ptr = child.buffer.data();
+                    auto size = _read<std::uint32_t>(ptr);
+                    if (child.buffer.size() < sizeof(std::uint32_t) + size) break;
+
+                    TestResult result{};
+#if OSTEST_STD_THREADS
+                    if (size == _timeoutFrame)
+                    {
+                        const TestInfo& test = *tests[child.batch[child.completed++]];
+                        (new _IsolatedAssertion(_timeoutExpression, test.file, test.line,
+                            _timeoutMessage, std::strlen(_timeoutMessage)))->evaluate(result, false);
+
+                        child.buffer.erase(0, sizeof(std::uint32_t));
+                        child.timedOut = true;
+                        notifyComplete(test, result);
+                        continue;
+                    }
+#endif
+                    result.setTimings(_read<TestTimings>(ptr));
+                    result.setBenchmarkStats(_read<BenchmarkStats>(ptr));
+                    bool allocationsTracked = _read<std::uint8_t>(ptr) != 0;
+                    auto allocationStats = _read<AllocationStats>(ptr);
+                    if (allocationsTracked) result.setAllocationStats(allocationStats);
+                    result.setPerfCounters(_read<PerfCounters>(ptr));
+                    auto assertions = _read<std::uint32_t>(ptr);
+                    for (std::uint32_t a = 0; a < assertions; a++)
+                    {
+                        bool passed = _read<std::uint8_t>(ptr) != 0;
+                        int line = _read<std::int32_t>(ptr);
+                        auto expression = _read<const char*>(ptr);
+                        auto file = _read<const char*>(ptr);
+                        auto messageLength = _read<std::uint32_t>(ptr);
+
+                        (new _IsolatedAssertion(expression, file, line, ptr, messageLength))
+                            ->evaluate(result, passed);
+                        ptr += messageLength;
+                    }
+                    child.buffer.erase(0, sizeof(std::uint32_t) + size);
+                    notifyComplete(*tests[child.batch[child.completed++]], result);
+                }
+                if (length > 0) continue;
+
+                // The child has exited
+                ::close(child.fd);
+                int status = 0;
+                while (::waitpid(child.pid, &status, 0) < 0 && errno == EINTR) { }
+
+                if (child.timedOut)
+                {
+                    // The test which timed out has already been reported
+                    if (child.completed < child.batch.size()) {
+                        pending.emplace_front(child.batch.begin() + child.completed, child.batch.end());
+                    }
+                }
+                else if (child.completed < child.batch.size())
+                {
+                    // Report the test being run as failed
+                    const TestInfo& test = *tests[child.batch[child.completed]];
+                    const char* expression = "<process terminated>";
+                    char message[128];
+
+                    if (WIFSIGNALED(status)) {
+                        std::snprintf(message, sizeof(message),
+                            "The test process was terminated by signal %d.", WTERMSIG(status));
+                    }
+                    else {
+                        std::snprintf(message, sizeof(message),
+                            "The test process exited unexpectedly with status %d.", WEXITSTATUS(status));
+                    }
+
+                    TestResult result{};
+                    (new _IsolatedAssertion(expression, test.file, test.line,
+                        message, std::strlen(message)))->evaluate(result, false);
+                    notifyComplete(test, result);
+
+                    // Reschedule the tests which had not yet run
+                    if (child.completed + 1 < child.batch.size()) {
+                        pending.emplace_front(child.batch.begin() + child.completed + 1,
+                            child.batch.end());
+                    }
+                }
+                children.erase(children.begin() + i);
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,57 @@
+/* ostest-isolate.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+
+#if OSTEST_POSIX
+namespace ostest
+{
+    /* Runs tests in a pool of forked child processes.
+
+       Tests are split into batches, each of which is run by a single child.
+       Children stream their results back to the parent, which rebuilds them
+       and calls 'notifyComplete' as for any other runner. Should a child die,
+       the test it was running is reported as failed and the remainder of its
+       batch is rescheduled on a new child. A test which exceeds its timeout
+       (see 'setDefaultTimeout') is likewise ended and reported as failed.
+       Should no child process be started, the remaining tests are reported
+       as failed.
+
+       Metadata created within a test body exists only in the child process,
+       so is not visible to 'notifyComplete'.
+       Requires ostest to be compiled with 'OSTEST_POSIX'. */
+    class IsolatedRunner
+    {
+    private:
+        unsigned int processCount;
+        _ostest_internal::size_t batchSize;
+
+    public:
+        /* Creates a new isolated runner. A process count of zero selects one
+           process per hardware thread. */
+        explicit IsolatedRunner(unsigned int processCount = 0,
+            _ostest_internal::size_t batchSize = 32) noexcept;
+
+        virtual ~IsolatedRunner() = default;
+
+    public:
+        /* Gets the maximum number of child processes run at once. */
+        inline unsigned int getProcessCount() const noexcept { return processCount; }
+
+        /* Gets the maximum number of tests given to each child process. */
+        inline _ostest_internal::size_t getBatchSize() const noexcept { return batchSize; }
+
+        /* Runs every registered test. */
+        void run();
+
+        /* Runs the given tests. Tests are started in approximately the given order. */
+        virtual void run(const TestInfo* const* tests, _ostest_internal::size_t count);
+
+    protected:
+        /* Called in the parent process once a test has completed. Calls
+           'handleTestComplete' by default, or queues the test on the active
+           'AsyncReporter' should one exist. */
+        virtual void notifyComplete(const TestInfo& info, const TestResult& result);
+    };
+}
+#endif
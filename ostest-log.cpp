@@ -0,0 +1,287 @@
+/* ostest-log.cpp - (c) 2018 James Renwick */
+#include "ostest-log.hpp"
+
+#if OSTEST_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace _ostest_internal
+{
+#if !OSTEST_NO_ALLOC
+    static void _copy(void* destination, const void* source, size_t length)
+    {
+        auto* to = static_cast<char*>(destination);
+        auto* from = static_cast<const char*>(source);
+        for (size_t i = 0; i < length; i++) to[i] = from[i];
+    }
+
+    // Grows the given array to hold at least 'required' items
+    template<typename T>
+    static void _reserve(T*& items, size_t count, size_t& capacity, size_t required)
+    {
+        if (required <= capacity) return;
+
+        size_t newCapacity = capacity == 0 ? 64 : capacity;
+        while (newCapacity < required) newCapacity *= 2;
+
+        T* newItems = new T[newCapacity];
+        _copy(newItems, items, count * sizeof(T));
+        delete[] items;
+        items = newItems;
+        capacity = newCapacity;
+    }
+
+    // Table of interned strings, in the order they were first seen
+    struct _LogStrings
+    {
+        char* data{};
+        size_t dataSize{};
+        size_t dataCapacity{};
+        unsigned int* offsets{};
+        size_t count{};
+        size_t offsetCapacity{};
+        _HashIndex table{}; // String ids, by the hash of each string
+
+        ~_LogStrings()
+        {
+            delete[] data;
+            delete[] offsets;
+        }
+
+        unsigned int intern(const char* str)
+        {
+            if (str == nullptr) str = "";
+
+            size_t length = _length(str);
+            unsigned int hash = _hashRange(str, length);
+            size_t id = table.find(hash, [this, str](size_t id) { return _streq(data + offsets[id], str); });
+            if (id != _notFound) return static_cast<unsigned int>(id);
+
+            _reserve(data, dataSize, dataCapacity, dataSize + length + 1);
+            _reserve(offsets, count, offsetCapacity, count + 1);
+            _copy(data + dataSize, str, length + 1);
+            offsets[count] = static_cast<unsigned int>(dataSize);
+            dataSize += length + 1;
+
+            table.add(count, [this](size_t id) {
+                const char* string = data + offsets[id];
+                return _hashRange(string, _length(string));
+            });
+            return static_cast<unsigned int>(count++);
+        }
+    };
+#endif
+}
+
+namespace ostest
+{
+    using namespace ::_ostest_internal;
+
+#if !OSTEST_NO_ALLOC
+    BinaryReporter::BinaryReporter(ReportWriter writer, void* context, char* buffer, size_t capacity)
+        : Reporter(writer, context, buffer, capacity), strings(new _LogStrings()) { }
+
+    BinaryReporter::~BinaryReporter()
+    {
+        delete strings;
+        delete[] tests;
+    }
+
+    void BinaryReporter::begin()
+    {
+        _LogHeader header{};
+        _copy(header.magic, _logMagic, sizeof(header.magic));
+        header.version = _logVersion;
+        header.byteOrder = 0x01020304;
+        write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    void BinaryReporter::report(const TestInfo& test, const TestResult& result)
+    {
+        _reserve(tests, testCount, testCapacity, testCount + 1);
+
+        _LogTest& entry = tests[testCount++];
+        entry = _LogTest{};
+        entry.suite = strings->intern(test.suite.name);
+        entry.name = strings->intern(test.name);
+        entry.file = strings->intern(test.file);
+        entry.line = test.line;
+        entry.firstAssertion = assertionCount;
+        entry.passed = result.succeeded();
+        entry.benchmark = test.isBenchmark();
+
+        TestDuration time = result.getTimings().total();
+        entry.wallTime = time.wallTime;
+        entry.cpuTime = time.cpuTime;
+
+        for (auto& assertion : result.getAssertions())
+        {
+            _LogAssertion record{};
+            record.expression = strings->intern(assertion.expression);
+            record.file = strings->intern(assertion.file);
+            record.message = strings->intern(assertion.getMessage());
+            record.line = assertion.line;
+            record.passed = assertion.passed();
+            write(reinterpret_cast<const char*>(&record), sizeof(record));
+
+            entry.assertionCount++;
+            if (!assertion.passed()) entry.failureCount++;
+        }
+        assertionCount += entry.assertionCount;
+    }
+
+    void BinaryReporter::end()
+    {
+        _LogTrailer trailer{};
+        trailer.testOffset = sizeof(_LogHeader) + assertionCount * sizeof(_LogAssertion);
+        trailer.testCount = testCount;
+        trailer.stringOffset = trailer.testOffset + testCount * sizeof(_LogTest);
+        trailer.stringCount = strings->count;
+        trailer.stringDataOffset = trailer.stringOffset + strings->count * sizeof(unsigned int);
+        trailer.stringDataSize = strings->dataSize;
+        _copy(trailer.magic, _logMagic, sizeof(trailer.magic));
+
+        write(reinterpret_cast<const char*>(tests), testCount * sizeof(_LogTest));
+        write(reinterpret_cast<const char*>(strings->offsets), strings->count * sizeof(unsigned int));
+        write(strings->data, strings->dataSize);
+
+        // Align the trailer
+        static const char padding[8]{};
+        size_t end = static_cast<size_t>(trailer.stringDataOffset + trailer.stringDataSize);
+        write(padding, (8 - end % 8) % 8);
+        write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+        flush();
+    }
+#endif
+
+
+    ResultLog::ResultLog(const void* data, size_t size) noexcept
+        : data(static_cast<const char*>(data)), size(size)
+    {
+        load();
+    }
+
+#if OSTEST_POSIX
+    ResultLog::ResultLog(const char* path) noexcept
+    {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return;
+
+        struct stat info{};
+        if (::fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void* address = ::mmap(nullptr, static_cast<size_t>(info.st_size),
+                PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED)
+            {
+                data = static_cast<const char*>(address);
+                size = static_cast<size_t>(info.st_size);
+                mapped = true;
+                load();
+            }
+        }
+        ::close(fd);
+    }
+#endif
+
+    ResultLog::~ResultLog()
+    {
+#if OSTEST_POSIX
+        if (mapped) ::munmap(const_cast<char*>(data), size);
+#endif
+    }
+
+    void ResultLog::load() noexcept
+    {
+        if (data == nullptr || size < sizeof(_LogHeader) + sizeof(_LogTrailer)) return;
+        if (reinterpret_cast<unsigned long long>(data) % alignof(_LogTest) != 0) return;
+
+        auto& header = *reinterpret_cast<const _LogHeader*>(data);
+        auto& trailer = *reinterpret_cast<const _LogTrailer*>(data + size - sizeof(_LogTrailer));
+        for (size_t i = 0; i < sizeof(_logMagic); i++) {
+            if (header.magic[i] != _logMagic[i] || trailer.magic[i] != _logMagic[i]) return;
+        }
+        if (header.version != _logVersion || header.byteOrder != 0x01020304) return;
+
+        // Check that each section lies within the log
+        unsigned long long end = size - sizeof(_LogTrailer);
+        if ((trailer.testOffset - sizeof(_LogHeader)) % sizeof(_LogAssertion) != 0 ||
+            trailer.testOffset > end || trailer.testCount > (end - trailer.testOffset) / sizeof(_LogTest) ||
+            trailer.stringOffset != trailer.testOffset + trailer.testCount * sizeof(_LogTest) ||
+            trailer.stringCount > (end - trailer.stringOffset) / sizeof(unsigned int) ||
+            trailer.stringDataOffset != trailer.stringOffset + trailer.stringCount * sizeof(unsigned int) ||
+            trailer.stringDataSize > end - trailer.stringDataOffset)
+        {
+            return;
+        }
+
+        auto strings = data + trailer.stringDataOffset;
+        auto offsets = reinterpret_cast<const unsigned int*>(data + trailer.stringOffset);
+        if (trailer.stringDataSize != 0 && strings[trailer.stringDataSize - 1] != '\0') return;
+        for (size_t i = 0; i < trailer.stringCount; i++) {
+            if (offsets[i] >= trailer.stringDataSize) return;
+        }
+
+        auto entries = reinterpret_cast<const _LogTest*>(data + trailer.testOffset);
+        unsigned long long recordCount = (trailer.testOffset - sizeof(_LogHeader)) / sizeof(_LogAssertion);
+        for (size_t i = 0; i < trailer.testCount; i++)
+        {
+            auto& test = entries[i];
+            if (test.suite >= trailer.stringCount || test.name >= trailer.stringCount ||
+                test.file >= trailer.stringCount || test.firstAssertion > recordCount ||
+                test.assertionCount > recordCount - test.firstAssertion)
+            {
+                return;
+            }
+        }
+
+        assertions = reinterpret_cast<const _LogAssertion*>(data + sizeof(_LogHeader));
+        testCount = static_cast<size_t>(trailer.testCount);
+        stringOffsets = offsets;
+        stringCount = static_cast<size_t>(trailer.stringCount);
+        stringData = strings;
+        tests = entries;
+    }
+
+    const char* ResultLog::getString(unsigned int id) const noexcept {
+        return id < stringCount ? stringData + stringOffsets[id] : "";
+    }
+
+    bool ResultLog::stringEquals(unsigned int id, const char* str) const noexcept {
+        return id < stringCount && _streq(stringData + stringOffsets[id], str);
+    }
+
+    LogTest ResultLog::getTest(size_t index) const noexcept
+    {
+        auto& entry = tests[index];
+
+        LogTest test{};
+        test.suite = getString(entry.suite);
+        test.name = getString(entry.name);
+        test.file = getString(entry.file);
+        test.line = entry.line;
+        test.passed = entry.passed != 0;
+        test.benchmark = entry.benchmark != 0;
+        test.assertionCount = entry.assertionCount;
+        test.failureCount = entry.failureCount;
+        test.duration = TestDuration{entry.wallTime, entry.cpuTime};
+        test.firstAssertion = entry.firstAssertion;
+        return test;
+    }
+
+    LogAssertion ResultLog::getAssertion(const LogTest& test, unsigned int index) const noexcept
+    {
+        auto& record = assertions[test.firstAssertion + index];
+
+        LogAssertion assertion{};
+        assertion.expression = getString(record.expression);
+        assertion.file = getString(record.file);
+        assertion.message = getString(record.message);
+        assertion.line = record.line;
+        assertion.passed = record.passed != 0;
+        return assertion;
+    }
+}
@@ -0,0 +1,199 @@
+/* ostest-log.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+#include "ostest-report.hpp"
+
+namespace _ostest_internal
+{
+    /* Layout of the binary result log. All values are in native byte order.
+
+       [header] [assertion record]* [test record]* [string offset]* [string data] [trailer]
+
+       Assertion records of each test are contiguous, in the order the tests were
+       reported. Strings are interned, and are referenced by their index. */
+    static constexpr const char _logMagic[8] = { 'O', 'S', 'T', 'E', 'S', 'T', 'L', 'G' };
+    static constexpr const unsigned int _logVersion = 1;
+
+    struct _LogHeader
+    {
+        char magic[8];
+        unsigned int version;
+        unsigned int byteOrder; // Always 0x01020304
+    };
+
+    struct _LogAssertion
+    {
+        unsigned int expression;
+        unsigned int file;
+        unsigned int message;
+        int line;
+        unsigned int passed;
+        unsigned int reserved;
+    };
+
+    struct _LogTest
+    {
+        unsigned int suite;
+        unsigned int name;
+        unsigned int file;
+        int line;
+        unsigned long long firstAssertion; // Index of the test's first assertion record
+        unsigned int assertionCount;
+        unsigned int failureCount;
+        unsigned int passed;
+        unsigned int benchmark;
+        unsigned long long wallTime;
+        unsigned long long cpuTime;
+    };
+
+    struct _LogTrailer
+    {
+        unsigned long long testOffset;
+        unsigned long long testCount;
+        unsigned long long stringOffset;
+        unsigned long long stringCount;
+        unsigned long long stringDataOffset;
+        unsigned long long stringDataSize;
+        char magic[8];
+    };
+
+    static_assert(sizeof(_LogHeader) == 16, "Unexpected log header size");
+    static_assert(sizeof(_LogAssertion) == 24, "Unexpected log assertion size");
+    static_assert(sizeof(_LogTest) == 56, "Unexpected log test size");
+    static_assert(sizeof(_LogTrailer) == 56, "Unexpected log trailer size");
+
+    struct _LogStrings;
+}
+
+namespace ostest
+{
+#if !OSTEST_NO_ALLOC
+    /* Reporter writing results as a compact binary log, readable with 'ResultLog'.
+
+       Each assertion is written as a fixed-size record as its test is reported.
+       Names, files, expressions and messages are interned, and written along with
+       an index of tests once 'end' is called. Only the unique strings and the
+       index are held in memory.
+       Not available with 'OSTEST_NO_ALLOC'. */
+    class BinaryReporter : public Reporter
+    {
+    private:
+        _ostest_internal::_LogStrings* strings;
+        _ostest_internal::_LogTest* tests{};
+        _ostest_internal::size_t testCount{};
+        _ostest_internal::size_t testCapacity{};
+        unsigned long long assertionCount{};
+
+    public:
+        BinaryReporter(ReportWriter writer, void* context, char* buffer,
+            _ostest_internal::size_t capacity);
+        ~BinaryReporter() override;
+
+        void begin() override;
+        void report(const TestInfo& test, const TestResult& result) override;
+        void end() override;
+    };
+#endif
+
+    /* A test read from a binary result log. */
+    struct LogTest
+    {
+        const char* suite;
+        const char* name;
+        const char* file;
+        int line;
+        bool passed;
+        bool benchmark;
+        unsigned int assertionCount;
+        unsigned int failureCount;
+        TestDuration duration;
+        unsigned long long firstAssertion;
+    };
+
+    /* An assertion read from a binary result log. */
+    struct LogAssertion
+    {
+        const char* expression;
+        const char* file;
+        const char* message;
+        int line;
+        bool passed;
+    };
+
+    /* Reader of binary result logs written by 'BinaryReporter'.
+
+       The log is used in place. Only the trailer, test index and string offsets
+       are validated on load - assertion records are read only when requested. */
+    class ResultLog
+    {
+    private:
+        const char* data{};
+        _ostest_internal::size_t size{};
+        const _ostest_internal::_LogAssertion* assertions{};
+        const _ostest_internal::_LogTest* tests{};
+        _ostest_internal::size_t testCount{};
+        const unsigned int* stringOffsets{};
+        _ostest_internal::size_t stringCount{};
+        const char* stringData{};
+        bool mapped{};
+
+    public:
+        /* Reads the log held in the given memory, which must outlive the reader. */
+        ResultLog(const void* data, _ostest_internal::size_t size) noexcept;
+
+#if OSTEST_POSIX
+        /* Memory-maps and reads the log at the given path.
+           Requires ostest to be compiled with 'OSTEST_POSIX'. */
+        explicit ResultLog(const char* path) noexcept;
+#endif
+        ResultLog(const ResultLog&) = delete;
+        ResultLog& operator =(const ResultLog&) = delete;
+
+        ~ResultLog();
+
+    public:
+        /* Returns whether the log was read successfully. */
+        inline bool valid() const noexcept { return tests != nullptr; }
+
+        /* Gets the number of tests in the log. */
+        inline _ostest_internal::size_t getTestCount() const noexcept { return testCount; }
+
+        /* Gets the test at the given index. */
+        LogTest getTest(_ostest_internal::size_t index) const noexcept;
+
+        /* Gets the assertion of the given test at the given index. */
+        LogAssertion getAssertion(const LogTest& test, unsigned int index) const noexcept;
+
+        /* Calls 'callback(const LogTest&, const LogAssertion&)' for each failed assertion
+           of each test in the given suite. Only records of failed tests are read. */
+        template<typename Fn>
+        void forEachFailure(const char* suite, Fn&& callback) const
+        {
+            // Tests of a suite are usually adjacent, so names are rarely compared
+            unsigned int current = ~0u;
+            bool selected = false;
+
+            for (_ostest_internal::size_t i = 0; i < testCount; i++)
+            {
+                if (tests[i].suite != current) {
+                    current = tests[i].suite;
+                    selected = stringEquals(current, suite);
+                }
+                if (!selected || tests[i].failureCount == 0) continue;
+
+                LogTest test = getTest(i);
+                for (unsigned int a = 0; a < test.assertionCount; a++)
+                {
+                    LogAssertion assertion = getAssertion(test, a);
+                    if (!assertion.passed) callback(test, assertion);
+                }
+            }
+        }
+
+    private:
+        void load() noexcept;
+        const char* getString(unsigned int id) const noexcept;
+        bool stringEquals(unsigned int id, const char* str) const noexcept;
+    };
+}
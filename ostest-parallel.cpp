@@ -0,0 +1,230 @@
+/* ostest-parallel.cpp - (c) 2018 James Renwick */
+#include "ostest.hpp"
+
+#if OSTEST_STD_THREADS
+#if OSTEST_NO_ALLOC
+#error Thread support requires allocation: cannot compile with both OSTEST_STD_THREADS and OSTEST_NO_ALLOC.
+#endif
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+    // Queue of tests waiting to be run by a single worker.
+    // The owning worker takes from the front, other workers steal from the back.
+    class _WorkQueue
+    {
+    private:
+        std::mutex lock{};
+        std::deque<const TestInfo*> tests{};
+
+    public:
+        void push(const TestInfo* test)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            tests.push_back(test);
+        }
+
+        bool pop(const TestInfo*& test)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (tests.empty()) return false;
+            test = tests.front();
+            tests.pop_front();
+            return true;
+        }
+
+        bool steal(const TestInfo*& test)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (tests.empty()) return false;
+            test = tests.back();
+            tests.pop_back();
+            return true;
+        }
+    };
+
+    // Heap storage with a given alignment.
+    class _AlignedStorage
+    {
+    private:
+        std::unique_ptr<char[]> data{};
+        void* ptr{};
+
+    public:
+        _AlignedStorage(size_t size, size_t align)
+            : data(new char[size + align])
+        {
+            auto address = reinterpret_cast<std::uintptr_t>(data.get());
+            ptr = reinterpret_cast<void*>((address + align - 1) & ~(align - 1));
+        }
+
+        inline void* get() const noexcept { return ptr; }
+    };
+
+    // Serialises calls to 'handleTestComplete' from worker threads
+    static std::mutex _handlerLock{};
+
+    // State shared between workers for a single run.
+    struct _ParallelRun
+    {
+        std::vector<_WorkQueue> queues;
+        std::mutex historyLock{};
+        size_t suiteSize = 1, suiteAlign = 1;
+        size_t testSize = 1, testAlign = 1;
+
+        explicit _ParallelRun(size_t workers) : queues(workers) { }
+    };
+
+    // Runner forwarding completed tests to the parallel runner.
+    class _WorkerRunner : public TestRunner
+    {
+    public:
+        using notify_fn = void (*)(void* context, const TestInfo&, const TestResult&);
+
+    private:
+        notify_fn notify;
+        void* context;
+
+    public:
+        _WorkerRunner(TestSuite& suite, const TestInfo& info, void* storage,
+            notify_fn notify, void* context)
+            : TestRunner(suite, info, storage), notify(notify), context(context) { }
+
+    protected:
+        void notifyComplete(const TestInfo& info, const TestResult& result) override {
+            notify(context, info, result);
+        }
+    };
+}
+
+namespace ostest
+{
+    using namespace ::_ostest_internal;
+
+    ParallelRunner::ParallelRunner(unsigned int threadCount, TestHistory* history, bool failedFirst) noexcept
+        : threadCount(threadCount), history(history), failedFirst(failedFirst)
+    {
+        if (this->threadCount == 0) this->threadCount = std::thread::hardware_concurrency();
+        if (this->threadCount == 0) this->threadCount = 1;
+    }
+
+    void ParallelRunner::run()
+    {
+        size_t count;
+        auto tests = _getAllTests(count);
+        run(tests, count);
+        delete[] tests;
+    }
+
+    void ParallelRunner::notifyComplete(const TestInfo& info, const TestResult& result)
+    {
+        // The reporter's queue is safe to push to from any thread
+        if (auto reporter = AsyncReporter::getActive()) return reporter->push(info, result);
+
+        std::lock_guard<std::mutex> guard(_handlerLock);
+        ::ostest::handleTestComplete(info, result);
+    }
+
+    void ParallelRunner::run(const TestInfo* const* tests, size_t count)
+    {
+        if (count == 0) return;
+
+        size_t workers = threadCount < count ? threadCount : count;
+        _ParallelRun state(workers);
+
+        // Size worker storage for the largest suite & test
+        for (size_t i = 0; i < count; i++)
+        {
+            auto& suite = tests[i]->suite;
+            if (suite.instanceSize() > state.suiteSize) state.suiteSize = suite.instanceSize();
+            if (suite.instanceAlign() > state.suiteAlign) state.suiteAlign = suite.instanceAlign();
+            if (tests[i]->instanceSize() > state.testSize) state.testSize = tests[i]->instanceSize();
+            if (tests[i]->instanceAlign() > state.testAlign) state.testAlign = tests[i]->instanceAlign();
+        }
+
+        if (history != nullptr)
+        {
+            // Deal out the longest tests first, so each worker starts with a slow test
+            // and steals the shortest remaining tests once idle
+            std::vector<const TestInfo*> scheduled(tests, tests + count);
+            history->schedule(scheduled.data(), count, failedFirst);
+            for (size_t i = 0; i < count; i++) state.queues[i % workers].push(scheduled[i]);
+        }
+        else
+        {
+            // Give each worker a contiguous block so that suites stay together
+            for (size_t w = 0; w < workers; w++)
+            {
+                size_t first = (count * w) / workers;
+                size_t last = (count * (w + 1)) / workers;
+                for (size_t i = first; i < last; i++) state.queues[w].push(tests[i]);
+            }
+        }
+
+        struct Context { ParallelRunner* runner; _ParallelRun* state; };
+        Context context{this, &state};
+
+        auto notify = [](void* ctx, const TestInfo& info, const TestResult& result)
+        {
+            auto& context = *static_cast<Context*>(ctx);
+            if (context.runner->history != nullptr)
+            {
+                std::lock_guard<std::mutex> guard(context.state->historyLock);
+                context.runner->history->record(info, result);
+            }
+            context.runner->notifyComplete(info, result);
+        };
+
+        auto worker = [&state, &context, notify, workers](size_t index)
+        {
+            _AlignedStorage suiteStorage(state.suiteSize, state.suiteAlign);
+            _AlignedStorage testStorage(state.testSize, state.testAlign);
+
+            const SuiteInfo* currentSuite = nullptr;
+            TestSuite* suite = nullptr;
+
+            while (true)
+            {
+                const TestInfo* test = nullptr;
+
+                // Take own work first, then try to steal from the others
+                if (!state.queues[index].pop(test))
+                {
+                    for (size_t i = 1; i < workers && test == nullptr; i++) {
+                        state.queues[(index + i) % workers].steal(test);
+                    }
+                }
+                // Nothing is added once started, so empty queues mean we are done
+                if (test == nullptr) break;
+
+                // Each worker holds its own instance of the current suite
+                if (&test->suite != currentSuite)
+                {
+                    if (currentSuite != nullptr) currentSuite->deleteInstance(suiteStorage.get());
+                    currentSuite = &test->suite;
+                    suite = &currentSuite->newInstance(suiteStorage.get());
+                }
+                _WorkerRunner(*suite, *test, testStorage.get(), notify, &context).run();
+            }
+            if (currentSuite != nullptr) currentSuite->deleteInstance(suiteStorage.get());
+        };
+
+        std::vector<std::thread> threads{};
+        for (size_t w = 1; w < workers; w++) threads.emplace_back(worker, w);
+
+        // The calling thread acts as the first worker
+        worker(0);
+        for (auto& thread : threads) thread.join();
+
+        if (history != nullptr && history->getPath() != nullptr) history->save();
+    }
+}
+#endif
@@ -0,0 +1,58 @@
+/* ostest-parallel.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+#include "ostest-history.hpp"
+
+#if OSTEST_STD_THREADS
+namespace ostest
+{
+    /* Runs tests concurrently across a pool of worker threads.
+
+       Each worker holds its own suite and test instances. Tests are shared
+       out between per-worker queues in suite order, and idle workers steal
+       from the back of other workers' queues.
+
+       Given a history, tests are instead scheduled longest-first and dealt
+       out in turn, so that slow tests start early rather than forming a long
+       tail. Each completed test is recorded in the history, which is saved to
+       its cache file once the run is complete.
+       Requires ostest to be compiled with 'OSTEST_STD_THREADS'. */
+    class ParallelRunner
+    {
+    private:
+        unsigned int threadCount;
+        TestHistory* history;
+        bool failedFirst;
+
+    public:
+        /* Creates a new parallel runner. A thread count of zero selects one
+           worker per hardware thread. Should 'failedFirst' be set, tests which
+           failed in the history are run before all others. */
+        explicit ParallelRunner(unsigned int threadCount = 0, TestHistory* history = nullptr,
+            bool failedFirst = false) noexcept;
+
+        virtual ~ParallelRunner() = default;
+
+    public:
+        /* Gets the number of worker threads used to run tests. */
+        inline unsigned int getThreadCount() const noexcept { return threadCount; }
+
+        /* Gets the history used to schedule tests, or null. */
+        inline TestHistory* getHistory() const noexcept { return history; }
+
+        /* Runs every registered test. */
+        void run();
+
+        /* Runs the given tests. Tests are started in approximately the given order. */
+        virtual void run(const TestInfo* const* tests, _ostest_internal::size_t count);
+
+    protected:
+        /* Called once a test has completed. Calls 'handleTestComplete' by default,
+           one call at a time, or queues the test on the active 'AsyncReporter'
+           without locking should one exist. Calls are made from worker threads,
+           and may be made concurrently. */
+        virtual void notifyComplete(const TestInfo& info, const TestResult& result);
+    };
+}
+#endif
@@ -0,0 +1,157 @@
+/* ostest-perf.cpp - (c) 2018 James Renwick */
+#include "ostest-perf.hpp"
+
+#if OSTEST_PERF_COUNTERS
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+    struct _PerfEvent
+    {
+        PerfCounter counter;
+        unsigned int type;
+        unsigned long long config;
+    };
+
+    static const _PerfEvent _hardwareEvents[] = {
+        {PerfCounter::Cycles,          PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PerfCounter::Instructions,    PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PerfCounter::BranchMisses,    PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PerfCounter::CacheMisses,     PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    };
+    static const _PerfEvent _softwareEvents[] = {
+        {PerfCounter::TaskClock,       PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+        {PerfCounter::PageFaults,      PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        {PerfCounter::ContextSwitches, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    };
+
+    // The field of 'PerfCounters' holding each counter
+    static unsigned long long PerfCounters::* const _perfFields[] = {
+        &PerfCounters::cycles, &PerfCounters::instructions, &PerfCounters::branchMisses,
+        &PerfCounters::cacheMisses, &PerfCounters::taskClock, &PerfCounters::pageFaults,
+        &PerfCounters::contextSwitches
+    };
+
+    // The counters of a thread, read together as a group
+    class _PerfGroup
+    {
+    private:
+        static constexpr const unsigned int maxCounters = 7;
+
+        int fds[maxCounters]{};
+        PerfCounter counters[maxCounters]{}; // The counter of each member, in the order read
+        unsigned int count = 0;
+        pid_t process = 0;                   // Counters opened by a parent process count its thread
+
+    public:
+        _PerfGroup() = default;
+        ~_PerfGroup() { close(); }
+
+        _PerfGroup(const _PerfGroup&) = delete;
+        _PerfGroup& operator =(const _PerfGroup&) = delete;
+
+        inline unsigned int size() const noexcept { return count; }
+        inline PerfCounter counter(unsigned int index) const noexcept { return counters[index]; }
+
+        /* Reads the time enabled, time running, then each counter. */
+        bool read(unsigned long long* values) noexcept
+        {
+            if (process != ::getpid())
+            {
+                close();
+                process = ::getpid();
+                // Software counters are only used should no hardware counter be permitted
+                if (!open(_hardwareEvents, sizeof(_hardwareEvents) / sizeof(_PerfEvent))) {
+                    open(_softwareEvents, sizeof(_softwareEvents) / sizeof(_PerfEvent));
+                }
+            }
+            if (count == 0) return false;
+
+            unsigned long long buffer[3 + maxCounters];
+            auto size = static_cast<size_t>((3 + count) * sizeof(unsigned long long));
+            if (::read(fds[0], buffer, size) != static_cast<ssize_t>(size) || buffer[0] != count) return false;
+
+            for (unsigned int i = 0; i < count + 2; i++) values[i] = buffer[i + 1];
+            return true;
+        }
+
+    private:
+        bool open(const _PerfEvent* events, unsigned int eventCount) noexcept
+        {
+            for (unsigned int i = 0; i < eventCount; i++)
+            {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = events[i].type;
+                attr.config = events[i].config;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                    PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                // The first counter opened leads the group
+                int fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1,
+                    count == 0 ? -1 : fds[0], PERF_FLAG_FD_CLOEXEC));
+                if (fd < 0) continue;
+
+                fds[count] = fd;
+                counters[count++] = events[i].counter;
+            }
+            return count != 0;
+        }
+
+        void close() noexcept
+        {
+            // Members are closed before the leader
+            while (count != 0) ::close(fds[--count]);
+        }
+    };
+
+    static _PerfGroup& _threadPerfGroup()
+    {
+        static thread_local _PerfGroup group;
+        return group;
+    }
+
+    _PerfMeasurement::_PerfMeasurement() noexcept {
+        started = _threadPerfGroup().read(start);
+    }
+
+    void _PerfMeasurement::end() noexcept
+    {
+        if (!started) return;
+        started = false;
+
+        auto& group = _threadPerfGroup();
+        unsigned long long finish[maxCounters + 2]{};
+        if (!group.read(finish)) return;
+
+        // Counters are scaled up should they have shared the hardware with others
+        auto enabled = finish[0] - start[0], running = finish[1] - start[1];
+        double scale = running != 0 && running < enabled ?
+            static_cast<double>(enabled) / static_cast<double>(running) : 1.0;
+
+        for (unsigned int i = 0; i < group.size(); i++)
+        {
+            auto counter = static_cast<unsigned int>(group.counter(i));
+            counters.*_perfFields[counter] = static_cast<unsigned long long>(
+                static_cast<double>(finish[i + 2] - start[i + 2]) * scale);
+            counters.measured |= 1u << counter;
+        }
+    }
+}
+#else
+namespace _ostest_internal
+{
+    _PerfMeasurement::_PerfMeasurement() noexcept { }
+    void _PerfMeasurement::end() noexcept { }
+}
+#endif
+#endif
@@ -0,0 +1,36 @@
+/* ostest-perf.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+
+/* When compiled with 'OSTEST_PERF_COUNTERS', ostest reads performance counters
+   around each test body using 'perf_event_open' (see 'TestResult::getPerfCounters').
+   Hardware counters are used where permitted, otherwise software counters.
+   The counters of each thread are opened once, when it first runs a test.
+   On platforms other than Linux, no counters are read. */
+#if OSTEST_PERF_COUNTERS
+namespace _ostest_internal
+{
+    // Reads the performance counters of this thread between creation and 'end'.
+    // Measurements may nest, as the counters are never reset.
+    class _PerfMeasurement
+    {
+    private:
+        static constexpr const unsigned int maxCounters = 7;
+
+        ::ostest::PerfCounters counters{};
+        unsigned long long start[maxCounters + 2]{}; // Time enabled, time running, then each counter
+        bool started = false;
+
+    public:
+        _PerfMeasurement() noexcept;
+
+        _PerfMeasurement(const _PerfMeasurement&) = delete;
+        _PerfMeasurement& operator =(const _PerfMeasurement&) = delete;
+
+        void end() noexcept;
+
+        inline const ::ostest::PerfCounters& getCounters() const noexcept { return counters; }
+    };
+}
+#endif
@@ -0,0 +1,252 @@
+/* ostest-report.cpp - (c) 2018 James Renwick */
+#include "ostest-report.hpp"
+
+#if OSTEST_POSIX
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+
+namespace ostest
+{
+    using _ostest_internal::size_t;
+
+#if OSTEST_POSIX
+    void writeToFile(void* context, const char* data, size_t length)
+    {
+        int fd = *static_cast<int*>(context);
+        while (length > 0)
+        {
+            ssize_t written = ::write(fd, data, length);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return;
+            data += written;
+            length -= static_cast<size_t>(written);
+        }
+    }
+#endif
+
+
+    Reporter::Reporter(ReportWriter writer, void* context, char* buffer, size_t capacity) noexcept
+        : writer(writer), context(context), buffer(buffer), capacity(buffer ? capacity : 0) { }
+
+    void Reporter::flush()
+    {
+        if (length != 0) writer(context, buffer, length);
+        length = 0;
+    }
+
+    void Reporter::write(const char* data, size_t length)
+    {
+        if (this->length + length > capacity)
+        {
+            flush();
+            // Write anything which would not fit directly
+            if (length > capacity) {
+                writer(context, data, length);
+                return;
+            }
+        }
+        for (size_t i = 0; i < length; i++) buffer[this->length + i] = data[i];
+        this->length += length;
+    }
+
+    void Reporter::write(const char* str) {
+        write(str, _ostest_internal::_length(str));
+    }
+
+    void Reporter::write(char c) {
+        write(&c, 1);
+    }
+
+    void Reporter::writeUnsigned(unsigned long long value)
+    {
+        char digits[20];
+        size_t count = 0;
+        do {
+            digits[sizeof(digits) - ++count] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        while (value != 0);
+        write(digits + sizeof(digits) - count, count);
+    }
+
+    void Reporter::writeSigned(long long value)
+    {
+        if (value >= 0) return writeUnsigned(static_cast<unsigned long long>(value));
+        write('-');
+        writeUnsigned(0ull - static_cast<unsigned long long>(value));
+    }
+
+
+    void JUnitReporter::writeEscaped(const char* str)
+    {
+        // Write runs of characters which need no escaping at once
+        const char* run = str;
+        for (; *str != '\0'; str++)
+        {
+            const char* entity;
+            switch (*str)
+            {
+                case '&': entity = "&amp;"; break;
+                case '<': entity = "&lt;"; break;
+                case '>': entity = "&gt;"; break;
+                case '"': entity = "&quot;"; break;
+                case '\'': entity = "&apos;"; break;
+                case '\t': case '\n': case '\r': continue;
+                default:
+                    // Other control characters may not appear in XML 1.0
+                    if (static_cast<unsigned char>(*str) >= 0x20) continue;
+                    entity = "?";
+            }
+            write(run, static_cast<size_t>(str - run));
+            write(entity);
+            run = str + 1;
+        }
+        write(run, static_cast<size_t>(str - run));
+    }
+
+    void JUnitReporter::begin() {
+        write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n");
+    }
+
+    void JUnitReporter::report(const TestInfo& test, const TestResult& result)
+    {
+        if (&test.suite != currentSuite)
+        {
+            if (currentSuite != nullptr) write("  </testsuite>\n");
+            currentSuite = &test.suite;
+            write("  <testsuite name=\"");
+            writeEscaped(test.suite.name);
+            write("\">\n");
+        }
+
+        // Time is in seconds, to nanosecond precision
+        unsigned long long time = result.getTimings().total().wallTime;
+        char fraction[10] = "000000000";
+        unsigned long long nanoseconds = time % 1000000000ull;
+        for (int i = 8; i >= 0; i--, nanoseconds /= 10) {
+            fraction[i] = static_cast<char>('0' + nanoseconds % 10);
+        }
+
+        write("    <testcase classname=\"");
+        writeEscaped(test.suite.name);
+        write("\" name=\"");
+        writeEscaped(test.name);
+        write("\" file=\"");
+        writeEscaped(test.file);
+        write("\" line=\"");
+        writeSigned(test.line);
+        write("\" time=\"");
+        writeUnsigned(time / 1000000000ull);
+        write('.');
+        write(fraction, 9);
+
+        if (result.succeeded()) {
+            write("\"/>\n");
+            return;
+        }
+        write("\">\n");
+
+        for (auto& assertion : result.getAssertions())
+        {
+            if (assertion.passed()) continue;
+
+            write("      <failure message=\"");
+            const char* message = assertion.getMessage();
+            writeEscaped(message ? message : "");
+            write("\" type=\"assertion\">");
+            writeEscaped(assertion.file);
+            write(':');
+            writeSigned(assertion.line);
+            write(": ");
+            writeEscaped(assertion.expression);
+            write("</failure>\n");
+        }
+        if (result.getFirstFailure() == nullptr) {
+            write("      <failure message=\"Failed assertions were not recorded.\" type=\"assertion\"/>\n");
+        }
+        write("    </testcase>\n");
+    }
+
+    void JUnitReporter::end()
+    {
+        if (currentSuite != nullptr) write("  </testsuite>\n");
+        currentSuite = nullptr;
+        write("</testsuites>\n");
+        flush();
+    }
+
+
+    void JsonReporter::writeString(const char* str)
+    {
+        static const char hex[] = "0123456789abcdef";
+
+        write('"');
+        const char* run = str;
+        for (; *str != '\0'; str++)
+        {
+            char c = *str;
+            if (c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20) continue;
+
+            write(run, static_cast<size_t>(str - run));
+            run = str + 1;
+
+            switch (c)
+            {
+                case '"': write("\\\""); break;
+                case '\\': write("\\\\"); break;
+                case '\n': write("\\n"); break;
+                case '\r': write("\\r"); break;
+                case '\t': write("\\t"); break;
+                default:
+                    char escape[] = { '\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF] };
+                    write(escape, sizeof(escape));
+            }
+        }
+        write(run, static_cast<size_t>(str - run));
+        write('"');
+    }
+
+    void JsonReporter::report(const TestInfo& test, const TestResult& result)
+    {
+        TestDuration time = result.getTimings().total();
+
+        write("{\"suite\":");
+        writeString(test.suite.name);
+        write(",\"test\":");
+        writeString(test.name);
+        write(",\"file\":");
+        writeString(test.file);
+        write(",\"line\":");
+        writeSigned(test.line);
+        write(",\"passed\":");
+        write(result.succeeded() ? "true" : "false");
+        write(",\"assertions\":");
+        writeUnsigned(result.getPassCount() + result.getFailureCount() + result.getDroppedAssertions());
+        write(",\"wallTime\":");
+        writeUnsigned(time.wallTime);
+        write(",\"cpuTime\":");
+        writeUnsigned(time.cpuTime);
+        write(",\"failures\":[");
+
+        bool first = true;
+        for (auto& assertion : result.getAssertions())
+        {
+            if (assertion.passed()) continue;
+
+            write(first ? "{\"expression\":" : ",{\"expression\":");
+            writeString(assertion.expression);
+            write(",\"file\":");
+            writeString(assertion.file);
+            write(",\"line\":");
+            writeSigned(assertion.line);
+            write(",\"message\":");
+            const char* message = assertion.getMessage();
+            writeString(message ? message : "");
+            write('}');
+            first = false;
+        }
+        write("]}\n");
+    }
+}
@@ -0,0 +1,97 @@
+/* ostest-report.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+
+namespace ostest
+{
+    /* Function receiving the output of a reporter. */
+    using ReportWriter = void (*)(void* context, const char* data, _ostest_internal::size_t length);
+
+#if OSTEST_POSIX
+    /* Report writer which writes to the file descriptor pointed to by 'context'.
+       Requires ostest to be compiled with 'OSTEST_POSIX'. */
+    void writeToFile(void* context, const char* data, _ostest_internal::size_t length);
+#endif
+
+    /* Base class of reporters, which write test results as they complete.
+
+       Output is collected in the given buffer, which is reused, and only passed
+       to the writer when full or when 'flush' is called. Nothing is retained
+       between tests, so the memory used does not grow with the number of tests.
+       Reporters are not synchronised - call 'report' from one thread at a time,
+       such as from 'handleTestComplete'. */
+    class Reporter
+    {
+    private:
+        ReportWriter writer;
+        void* context;
+        char* buffer;
+        _ostest_internal::size_t capacity;
+        _ostest_internal::size_t length{};
+
+    public:
+        /* Creates a new reporter writing to the given writer through the given buffer. */
+        Reporter(ReportWriter writer, void* context, char* buffer,
+            _ostest_internal::size_t capacity) noexcept;
+
+        Reporter(const Reporter&) = delete;
+        Reporter& operator =(const Reporter&) = delete;
+
+        virtual ~Reporter() = default;
+
+    public:
+        /* Writes any output preceding the first result. */
+        virtual void begin() { }
+
+        /* Writes the result of a completed test. */
+        virtual void report(const TestInfo& test, const TestResult& result) = 0;
+
+        /* Writes any output following the final result, then flushes the buffer. */
+        virtual void end() { flush(); }
+
+        /* Passes all buffered output to the writer. */
+        void flush();
+
+    protected:
+        void write(const char* data, _ostest_internal::size_t length);
+        void write(const char* str);
+        void write(char c);
+        void writeUnsigned(unsigned long long value);
+        void writeSigned(long long value);
+    };
+
+
+    /* Reporter writing results as JUnit XML.
+       Consecutive tests of the same suite are grouped into a single <testsuite>
+       element. Times are written in seconds, assuming a nanosecond wall clock. */
+    class JUnitReporter : public Reporter
+    {
+    private:
+        const SuiteInfo* currentSuite{};
+
+    public:
+        using Reporter::Reporter;
+
+        void begin() override;
+        void report(const TestInfo& test, const TestResult& result) override;
+        void end() override;
+
+    private:
+        void writeEscaped(const char* str);
+    };
+
+
+    /* Reporter writing results as JSON Lines - one JSON object per test.
+       Times are written in wall and CPU clock ticks. */
+    class JsonReporter : public Reporter
+    {
+    public:
+        using Reporter::Reporter;
+
+        void report(const TestInfo& test, const TestResult& result) override;
+
+    private:
+        void writeString(const char* str);
+    };
+}
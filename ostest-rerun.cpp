@@ -0,0 +1,219 @@
+/* ostest-rerun.cpp - (c) 2018 James Renwick */
+#include "ostest.hpp"
+
+#if !OSTEST_NO_ALLOC
+#include <cstdio>
+
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+    static constexpr const char* _rerunHeader = "ostest-failed 1\n";
+
+    struct _FailedEntry
+    {
+        char* key; // The suite name, test name and file, each null-terminated
+        const char* name;
+        const char* file;
+        int line;
+        unsigned int hash;
+        bool failed;
+        bool registered; // Whether the test is registered, or only named by the state file
+    };
+
+    // Copies the given strings into a single allocation, each null-terminated
+    static char* _joinStrings(const char* const* strings, const size_t* lengths, size_t count)
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) total += lengths[i] + 1;
+
+        char* data = new char[total];
+        char* ptr = data;
+        for (size_t i = 0; i < count; i++)
+        {
+            for (size_t c = 0; c < lengths[i]; c++) *ptr++ = strings[i][c];
+            *ptr++ = '\0';
+        }
+        return data;
+    }
+
+    // Parses "<line> <suite> <name> <file>\n", giving pointers to the fields
+    static bool _parseFailed(const char*& ptr, const char* end, const char** fields,
+        size_t* lengths, int& line)
+    {
+        if (ptr == end || *ptr < '0' || *ptr > '9') return false;
+        long long value = 0;
+        for (; ptr != end && *ptr >= '0' && *ptr <= '9'; ptr++)
+        {
+            value = value * 10 + (*ptr - '0');
+            if (value > 0x7FFFFFFF) return false;
+        }
+        line = static_cast<int>(value);
+
+        // The suite and test names end at a space, the file at the end of the line
+        for (size_t i = 0; i < 3; i++)
+        {
+            if (ptr == end || *ptr != ' ') return false;
+            fields[i] = ++ptr;
+            while (ptr != end && *ptr != '\n' && (i == 2 || *ptr != ' ')) ptr++;
+            lengths[i] = static_cast<size_t>(ptr - fields[i]);
+            if (lengths[i] == 0) return false;
+        }
+        if (ptr == end) return false;
+        ptr++;
+        return true;
+    }
+}
+
+namespace ostest
+{
+    using namespace ::_ostest_internal;
+
+    RerunState::RerunState(const char* path)
+    {
+        size_t pathLength = _length(path);
+        this->path = _joinStrings(&path, &pathLength, 1);
+
+        // Read the state file, should it exist
+        size_t size;
+        if (char* data = _readFile(path, size))
+        {
+            const char* end = data + size;
+            const char* ptr = data;
+            for (const char* header = _rerunHeader; *header != '\0'; header++, ptr++)
+            {
+                if (ptr == end || *ptr != *header) {
+                    ptr = end;
+                    break;
+                }
+            }
+
+            // Lines after any which are invalid are ignored
+            const char* fields[3];
+            size_t lengths[3];
+            int line;
+            while (ptr != end && _parseFailed(ptr, end, fields, lengths, line))
+            {
+                char* key = _joinStrings(fields, lengths, 3);
+                add(key, key + lengths[0] + 1, key + lengths[0] + lengths[1] + 2, line);
+                delete[] key;
+            }
+            delete[] data;
+        }
+
+        // Select the registered tests which had failed
+        size_t testCount;
+        selected = _getAllTests(testCount);
+
+        if (entryCount == 0) return;
+        for (size_t i = 0; i < testCount; i++)
+        {
+            const TestInfo& test = *selected[i];
+            if (auto entry = find(test.suite.name, test.name, test.file))
+            {
+                entry->registered = true;
+                selected[count++] = &test;
+            }
+        }
+
+        // Tests since removed or renamed are dropped, so are not saved again
+        size_t kept = 0;
+        for (size_t i = 0; i < entryCount; i++)
+        {
+            if (entries[i].registered) entries[kept++] = entries[i];
+            else delete[] entries[i].key;
+        }
+        if (kept != entryCount)
+        {
+            entryCount = kept;
+            table.rebuild(entryCount, [this](size_t index) { return entries[index].hash; });
+        }
+    }
+
+    RerunState::~RerunState()
+    {
+        for (size_t i = 0; i < entryCount; i++) delete[] entries[i].key;
+        delete[] entries;
+        delete[] selected;
+        delete[] path;
+    }
+
+    _FailedEntry* RerunState::find(const char* suite, const char* name, const char* file) const noexcept
+    {
+        unsigned int hash = _hashTestName(suite, name);
+        size_t index = table.find(hash, [&](size_t index) {
+            const _FailedEntry& entry = entries[index];
+            return entry.hash == hash && _streq(entry.key, suite) && _streq(entry.name, name) &&
+                _streq(entry.file, file);
+        });
+        return index != _notFound ? &entries[index] : nullptr;
+    }
+
+    _FailedEntry& RerunState::add(const char* suite, const char* name, const char* file, int line)
+    {
+        if (auto entry = find(suite, name, file))
+        {
+            entry->line = line;
+            entry->failed = true;
+            return *entry;
+        }
+
+        if (entryCount == capacity)
+        {
+            capacity = capacity == 0 ? 16 : capacity * 2;
+            auto newEntries = new _FailedEntry[capacity];
+            for (size_t i = 0; i < entryCount; i++) newEntries[i] = entries[i];
+            delete[] entries;
+            entries = newEntries;
+        }
+
+        const char* strings[3] = {suite, name, file};
+        size_t lengths[3] = {_length(suite), _length(name), _length(file)};
+        _FailedEntry& entry = entries[entryCount++];
+        entry.key = _joinStrings(strings, lengths, 3);
+        entry.name = entry.key + lengths[0] + 1;
+        entry.file = entry.name + lengths[1] + 1;
+        entry.line = line;
+        entry.hash = _hashTestName(suite, name);
+        entry.failed = true;
+        entry.registered = false;
+
+        table.add(entryCount - 1, [this](size_t index) { return entries[index].hash; });
+        return entry;
+    }
+
+    size_t RerunState::getFailedCount() const noexcept
+    {
+        size_t failed = 0;
+        for (size_t i = 0; i < entryCount; i++) {
+            if (entries[i].failed) failed++;
+        }
+        return failed;
+    }
+
+    void RerunState::run() {
+        _runTests(selected, count);
+    }
+
+    void RerunState::record(const TestInfo& test, const TestResult& result)
+    {
+        if (!result.succeeded()) add(test.suite.name, test.name, test.file, test.line).registered = true;
+        else if (auto entry = find(test.suite.name, test.name, test.file)) entry->failed = false;
+    }
+
+    bool RerunState::save() const
+    {
+        std::FILE* file = std::fopen(path, "wb");
+        if (file == nullptr) return false;
+
+        bool success = std::fputs(_rerunHeader, file) >= 0;
+        for (size_t i = 0; i < entryCount && success; i++)
+        {
+            auto& entry = entries[i];
+            if (!entry.failed) continue;
+            success = std::fprintf(file, "%d %s %s %s\n", entry.line, entry.key, entry.name, entry.file) > 0;
+        }
+        return std::fclose(file) == 0 && success;
+    }
+}
+#endif
@@ -0,0 +1,71 @@
+/* ostest-rerun.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+
+#if !OSTEST_NO_ALLOC
+namespace _ostest_internal
+{
+    struct _FailedEntry;
+}
+
+namespace ostest
+{
+    /* Records the tests which failed in a state file, so that only those
+       tests need be rerun.
+
+       Tests are identified by suite name, test name and file. The line is
+       also stored, but is not compared, so that tests are still found after
+       unrelated edits. On creation, the tests recorded as failed are looked
+       up within the registered tests, and those no longer registered are
+       dropped. Each test then recorded is added to the state should it fail,
+       or removed should it pass.
+       Not available with 'OSTEST_NO_ALLOC'. */
+    class RerunState
+    {
+    private:
+        _ostest_internal::_FailedEntry* entries{};
+        _ostest_internal::size_t entryCount{};
+        _ostest_internal::size_t capacity{};
+        _ostest_internal::_HashIndex table{}; // Entries, by the hash of their names
+        const TestInfo** selected{};
+        _ostest_internal::size_t count{};
+        char* path{};
+
+    public:
+        /* Creates the state stored in the given file, loading it should it exist. */
+        explicit RerunState(const char* path);
+
+        RerunState(const RerunState&) = delete;
+        RerunState& operator =(const RerunState&) = delete;
+
+        ~RerunState();
+
+    public:
+        /* Gets the registered tests which had failed when the state was loaded,
+           in registration order. */
+        inline const TestInfo* const* tests() const noexcept { return selected; }
+
+        /* Gets the number of tests which had failed when the state was loaded. */
+        inline _ostest_internal::size_t getCount() const noexcept { return count; }
+
+        /* Gets the number of tests currently recorded as failed. */
+        _ostest_internal::size_t getFailedCount() const noexcept;
+
+        /* Runs the tests which had failed. Suite instances are only created
+           for suites with at least one such test. */
+        void run();
+
+        /* Records the outcome of a completed test. Not thread-safe. */
+        void record(const TestInfo& test, const TestResult& result);
+
+        /* Writes the tests currently recorded as failed to the state file. */
+        bool save() const;
+
+    private:
+        _ostest_internal::_FailedEntry* find(const char* suite, const char* name,
+            const char* file) const noexcept;
+        _ostest_internal::_FailedEntry& add(const char* suite, const char* name, const char* file, int line);
+    };
+}
+#endif
@@ -0,0 +1,202 @@
+/* ostest-shard.cpp - (c) 2018 James Renwick */
+#include "ostest.hpp"
+
+#if !OSTEST_NO_ALLOC
+#include <cstdlib>
+#endif
+
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+    // Hashes "SuiteName.TestName", mixing the result so that each bit is usable
+    static unsigned int _shardHash(const TestInfo& test)
+    {
+        unsigned int hash = _hashTestName(test.suite.name, test.name);
+        hash = (hash ^ (hash >> 16)) * 0x85ebca6bu;
+        hash = (hash ^ (hash >> 13)) * 0xc2b2ae35u;
+        return hash ^ (hash >> 16);
+    }
+
+#if !OSTEST_NO_ALLOC
+    // A test to be assigned to a shard by duration
+    struct _ShardItem
+    {
+        size_t position;
+        unsigned int hash;
+        unsigned long long duration;
+        bool recorded;
+    };
+
+    // Orders items longest-first. Ties are broken by name, so that the
+    // order does not depend upon the order in which tests are given.
+    static bool _before(const _ShardItem& a, const _ShardItem& b, const TestInfo* const* tests)
+    {
+        if (a.duration != b.duration) return a.duration > b.duration;
+        if (a.hash != b.hash) return a.hash < b.hash;
+
+        const TestInfo& testA = *tests[a.position];
+        const TestInfo& testB = *tests[b.position];
+        int suiteOrder = _compare(testA.suite.name, testB.suite.name);
+        if (suiteOrder != 0) return suiteOrder < 0;
+        return _compare(testA.name, testB.name) < 0;
+    }
+
+    // Assigns each test to a shard, balancing the recorded durations of each shard
+    static void _balanceShards(const TestInfo* const* tests, size_t count, unsigned int total,
+        const TestHistory& history, unsigned int* shards)
+    {
+        auto items = new _ShardItem[count > 0 ? count : 1];
+        for (size_t i = 0; i < count; i++)
+        {
+            items[i] = _ShardItem{i, _shardHash(*tests[i]), 0, false};
+            items[i].recorded = history.getDuration(*tests[i], items[i].duration);
+        }
+
+        // Move recorded tests to the front, then sort them longest-first
+        size_t recorded = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!items[i].recorded) continue;
+            _ShardItem item = items[i];
+            items[i] = items[recorded];
+            items[recorded++] = item;
+        }
+        _sort(items, recorded, [tests](const _ShardItem& a, const _ShardItem& b) {
+            return _before(a, b, tests);
+        });
+
+        // Give each test to the least-loaded shard
+        auto loads = new unsigned long long[total]();
+        for (size_t i = 0; i < recorded; i++)
+        {
+            unsigned int shard = 0;
+            for (unsigned int s = 1; s < total; s++) {
+                if (loads[s] < loads[shard]) shard = s;
+            }
+            loads[shard] += items[i].duration;
+            shards[items[i].position] = shard;
+        }
+        for (size_t i = recorded; i < count; i++) {
+            shards[items[i].position] = items[i].hash % total;
+        }
+        delete[] loads;
+        delete[] items;
+    }
+
+    static bool _readUnsigned(const char* name, unsigned int& value)
+    {
+        const char* str = std::getenv(name);
+        if (str == nullptr || *str == '\0') return false;
+
+        unsigned long long result = 0;
+        for (; *str != '\0'; str++)
+        {
+            if (*str < '0' || *str > '9') return false;
+            result = result * 10 + static_cast<unsigned int>(*str - '0');
+            if (result > 0xFFFFFFFFull) return false;
+        }
+        value = static_cast<unsigned int>(result);
+        return true;
+    }
+#endif
+}
+
+namespace ostest
+{
+    using namespace ::_ostest_internal;
+
+    unsigned int getTestShard(const TestInfo& test, unsigned int totalShards) noexcept
+    {
+        if (totalShards <= 1) return 0;
+        return _shardHash(test) % totalShards;
+    }
+
+#if !OSTEST_NO_ALLOC
+    TestShard::TestShard(unsigned int index, unsigned int total)
+    {
+        size_t testCount;
+        auto allTests = _getAllTests(testCount);
+        select(allTests, testCount, index, total, nullptr);
+        delete[] allTests;
+    }
+
+    TestShard::TestShard(const TestInfo* const* tests, size_t count, unsigned int index, unsigned int total) {
+        select(tests, count, index, total, nullptr);
+    }
+
+    TestShard::TestShard(unsigned int index, unsigned int total, const TestHistory& history)
+    {
+        size_t testCount;
+        auto allTests = _getAllTests(testCount);
+        select(allTests, testCount, index, total, &history);
+        delete[] allTests;
+    }
+
+    TestShard::TestShard(const TestInfo* const* tests, size_t count, unsigned int index,
+        unsigned int total, const TestHistory& history)
+    {
+        select(tests, count, index, total, &history);
+    }
+
+    TestShard::TestShard(unsigned int index, unsigned int total, const ResultLog& log)
+    {
+        TestHistory history{};
+        history.record(log);
+
+        size_t testCount;
+        auto allTests = _getAllTests(testCount);
+        select(allTests, testCount, index, total, &history);
+        delete[] allTests;
+    }
+
+    TestShard::TestShard(const TestInfo* const* tests, size_t count, unsigned int index,
+        unsigned int total, const ResultLog& log)
+    {
+        TestHistory history{};
+        history.record(log);
+        select(tests, count, index, total, &history);
+    }
+
+    void TestShard::select(const TestInfo* const* tests, size_t count, unsigned int index,
+        unsigned int total, const TestHistory* history)
+    {
+        selected = new const TestInfo*[count > 0 ? count : 1];
+        if (history == nullptr)
+        {
+            for (size_t i = 0; i < count; i++) {
+                if (getTestShard(*tests[i], total) == index) selected[this->count++] = tests[i];
+            }
+            return;
+        }
+
+        auto shards = new unsigned int[count > 0 ? count : 1];
+        _balanceShards(tests, count, total > 0 ? total : 1, *history, shards);
+        for (size_t i = 0; i < count; i++) {
+            if (shards[i] == index) selected[this->count++] = tests[i];
+        }
+        delete[] shards;
+    }
+
+    TestShard::~TestShard() {
+        delete[] selected;
+    }
+
+    void TestShard::run() {
+        _runTests(selected, count);
+    }
+
+    bool TestShard::getEnvironmentShard(unsigned int& index, unsigned int& total) noexcept
+    {
+        unsigned int newIndex, newTotal;
+        if (!_readUnsigned("OSTEST_SHARD_INDEX", newIndex) ||
+            !_readUnsigned("OSTEST_TOTAL_SHARDS", newTotal) || newIndex >= newTotal)
+        {
+            return false;
+        }
+        index = newIndex;
+        total = newTotal;
+        return true;
+    }
+#endif
+}
@@ -0,0 +1,88 @@
+/* ostest-shard.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+#include "ostest-history.hpp"
+
+namespace ostest
+{
+    class ResultLog;
+
+    /* Gets the shard, of the given number of shards, to which the test belongs.
+       Depends only upon the names of the test and its suite, so is unaffected
+       by the addition or removal of other tests. */
+    unsigned int getTestShard(const TestInfo& test, unsigned int totalShards) noexcept;
+}
+
+#if !OSTEST_NO_ALLOC
+namespace ostest
+{
+    /* Selects the tests belonging to one of a number of shards, so that a suite
+       may be split deterministically across machines.
+
+       By default tests are assigned by a hash of their names (see 'getTestShard').
+       In duration-balanced mode, tests are instead assigned longest-first to the
+       shard with the least total duration, using durations recorded by an earlier
+       run in a 'TestHistory' or binary result log. Tests without a recorded
+       duration are assigned by name. Each machine must be given the same
+       history for the shards to partition the tests.
+       Not available with 'OSTEST_NO_ALLOC'. */
+    class TestShard
+    {
+    private:
+        const TestInfo** selected{};
+        _ostest_internal::size_t count{};
+
+    public:
+        /* Selects the registered tests belonging to the given shard. */
+        TestShard(unsigned int index, unsigned int total);
+
+        /* Selects those of the given tests belonging to the given shard. */
+        TestShard(const TestInfo* const* tests, _ostest_internal::size_t count,
+            unsigned int index, unsigned int total);
+
+        /* Selects the registered tests belonging to the given shard, balancing
+           shards by the durations recorded in the given history. */
+        TestShard(unsigned int index, unsigned int total, const TestHistory& history);
+
+        /* Selects those of the given tests belonging to the given shard, balancing
+           shards by the durations recorded in the given history. */
+        TestShard(const TestInfo* const* tests, _ostest_internal::size_t count,
+            unsigned int index, unsigned int total, const TestHistory& history);
+
+        /* Selects the registered tests belonging to the given shard, balancing
+           shards by the durations recorded in the given log. */
+        TestShard(unsigned int index, unsigned int total, const ResultLog& log);
+
+        /* Selects those of the given tests belonging to the given shard, balancing
+           shards by the durations recorded in the given log. */
+        TestShard(const TestInfo* const* tests, _ostest_internal::size_t count,
+            unsigned int index, unsigned int total, const ResultLog& log);
+
+        TestShard(const TestShard&) = delete;
+        TestShard& operator =(const TestShard&) = delete;
+
+        ~TestShard();
+
+    public:
+        /* Gets the selected tests, in the order given. */
+        inline const TestInfo* const* tests() const noexcept { return selected; }
+
+        /* Gets the number of selected tests. */
+        inline _ostest_internal::size_t getCount() const noexcept { return count; }
+
+        /* Runs the selected tests in order. Suite instances are only created
+           for suites with at least one selected test. */
+        void run();
+
+        /* Reads the shard from the 'OSTEST_SHARD_INDEX' and 'OSTEST_TOTAL_SHARDS'
+           environment variables. Returns false, leaving the arguments unchanged,
+           should either be unset or invalid. */
+        static bool getEnvironmentShard(unsigned int& index, unsigned int& total) noexcept;
+
+    private:
+        void select(const TestInfo* const* tests, _ostest_internal::size_t count,
+            unsigned int index, unsigned int total, const TestHistory* history);
+    };
+}
+#endif
@@ -0,0 +1,200 @@
+/* ostest-timeout.cpp - (c) 2018 James Renwick */
+#include "ostest-timeout.hpp"
+#include "ostest-async.hpp"
+
+#if OSTEST_STD_THREADS
+#if OSTEST_NO_ALLOC
+#error Thread support requires allocation: cannot compile with both OSTEST_STD_THREADS and OSTEST_NO_ALLOC.
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+    static unsigned long long _now()
+    {
+        return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    class _TimeoutAssertion : public CustomAssertion
+    {
+    public:
+        explicit _TimeoutAssertion(const TestInfo& info) : CustomAssertion(&message, &destroy,
+            _timeoutExpression, _heapalloc_tag{}, info.file, info.line, true) { }
+
+    private:
+        static const char* message(const CustomAssertion&) {
+            return _timeoutMessage;
+        }
+        static void destroy(CustomAssertion* assertion) {
+            delete static_cast<_TimeoutAssertion*>(assertion);
+        }
+    };
+
+    static std::atomic<unsigned int> defaultTimeout{0};
+    static thread_local _Watch* currentWatch = nullptr;
+
+    // Tracks the deadlines of running tests, started on first use.
+    // Never destroyed, as its thread may still be waiting on exit.
+    struct _Watchdog
+    {
+        std::mutex lock{};
+        std::condition_variable changed{};
+        _Watch* firstWatch{};
+        TimeoutHandler handler{};
+        bool started{};
+
+        void add(_Watch& watch)
+        {
+            watch.nextWatch = firstWatch;
+            firstWatch = &watch;
+            watch.armed = true;
+
+            if (!started)
+            {
+                std::thread([this]() { run(); }).detach();
+                started = true;
+            }
+            changed.notify_one();
+        }
+
+        void remove(_Watch& watch)
+        {
+            _Watch** link = &firstWatch;
+            while (*link != &watch) link = &(*link)->nextWatch;
+            *link = watch.nextWatch;
+            watch.armed = false;
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            while (true)
+            {
+                _Watch* earliest = firstWatch;
+                for (_Watch* watch = firstWatch; watch != nullptr; watch = watch->nextWatch) {
+                    if (watch->deadline < earliest->deadline) earliest = watch;
+                }
+
+                if (earliest == nullptr) {
+                    changed.wait(guard);
+                    continue;
+                }
+                unsigned long long now = _now();
+                if (now < earliest->deadline) {
+                    changed.wait_for(guard, std::chrono::milliseconds(earliest->deadline - now));
+                    continue;
+                }
+
+                // The lock is kept while abandoning the test, so that it cannot also complete
+                remove(*earliest);
+                if (handler == nullptr) earliest->abandon();
+
+                // The test remains running, so its info stays valid while handled
+                const TestInfo& info = earliest->info;
+                TimeoutHandler handle = handler;
+
+                guard.unlock();
+                handle(info);
+                guard.lock();
+            }
+        }
+    };
+
+    static _Watchdog*& _watchdogInstance()
+    {
+        static _Watchdog* watchdog = new _Watchdog();
+        return watchdog;
+    }
+
+    _Watch::_Watch(const TestInfo& info, TestRunner& runner)
+        : info(info), runner(runner), start(_now()), previous(currentWatch)
+    {
+        currentWatch = this;
+
+        unsigned int timeout = defaultTimeout.load(std::memory_order_relaxed);
+        // Metadata created by an earlier run of the test overrides the default
+        if (auto metadata = info.getMetadata<unsigned int>(OSTEST_METADATA_NAME("timeout_ms"))) timeout = metadata->value;
+        if (timeout != 0) arm(timeout);
+    }
+
+    void _Watch::arm(unsigned int timeout)
+    {
+        _Watchdog& watchdog = *_watchdogInstance();
+        std::lock_guard<std::mutex> guard(watchdog.lock);
+
+        if (armed) watchdog.remove(*this);
+        if (timeout != 0)
+        {
+            watched = true;
+            deadline = start + timeout;
+            watchdog.add(*this);
+        }
+    }
+
+    void _Watch::end()
+    {
+        if (ended) return;
+        ended = true;
+        currentWatch = previous;
+
+        // Tests which were never watched need not take the lock
+        if (watched) arm(0);
+    }
+
+    void _Watch::abandon() const
+    {
+        TestResult result{};
+        (new _TimeoutAssertion(info))->evaluate(result, false);
+        runner.notifyComplete(info, result);
+
+        if (auto reporter = AsyncReporter::getActive()) reporter->flush();
+        std::fflush(nullptr);
+        std::_Exit(EXIT_FAILURE);
+    }
+
+    void _metadataCreated(const Metadata<unsigned int>& metadata) noexcept
+    {
+        if (currentWatch != nullptr && _streq(metadata.name, "timeout_ms")) {
+            currentWatch->arm(metadata.value);
+        }
+    }
+
+    void _resetWatchdog(TimeoutHandler handler)
+    {
+        // The previous watchdog's lock may have been held by another thread when forked
+        _watchdogInstance() = new _Watchdog();
+        _watchdogInstance()->handler = handler;
+        currentWatch = nullptr;
+    }
+}
+
+namespace ostest
+{
+    using namespace ::_ostest_internal;
+
+    void setDefaultTimeout(unsigned int milliseconds) noexcept {
+        defaultTimeout.store(milliseconds, std::memory_order_relaxed);
+    }
+
+    unsigned int getDefaultTimeout() noexcept {
+        return defaultTimeout.load(std::memory_order_relaxed);
+    }
+
+    void setTimeoutHandler(TimeoutHandler handler) noexcept
+    {
+        _Watchdog& watchdog = *_watchdogInstance();
+        std::lock_guard<std::mutex> guard(watchdog.lock);
+        watchdog.handler = handler;
+    }
+}
+#endif
@@ -0,0 +1,76 @@
+/* ostest-timeout.hpp - (c) 2018 James Renwick */
+#pragma once
+
+#include "ostest-impl.hpp"
+
+#if OSTEST_STD_THREADS
+namespace ostest
+{
+    /* Sets the time allowed for each test (including setUp and tearDown), in
+       milliseconds. Zero, the default, allows tests unlimited time.
+       Tests may override this with 'Metadata<unsigned int>' named "timeout_ms",
+       which takes effect from when the metadata is created.
+       Requires ostest to be compiled with 'OSTEST_STD_THREADS'. */
+    void setDefaultTimeout(unsigned int milliseconds) noexcept;
+
+    /* Gets the time allowed for each test, in milliseconds. */
+    unsigned int getDefaultTimeout() noexcept;
+
+    /* Function called on the watchdog thread when a test exceeds its timeout. */
+    using TimeoutHandler = void (*)(const TestInfo& test);
+
+    /* Sets the function called when a test exceeds its timeout, or null for the default.
+
+       A test cannot safely be abandoned while it runs, so by default the test is
+       reported with a timeout failure through its runner's 'notifyComplete', the
+       active 'AsyncReporter' (if any) and standard output are flushed, and the
+       process exits with 'EXIT_FAILURE'. Tests already completed have been
+       reported, while those remaining are not run. 'IsolatedRunner' instead ends
+       only the child process running the test, and continues with the remaining
+       tests. Should a handler be set and return, the test continues to run. */
+    void setTimeoutHandler(TimeoutHandler handler) noexcept;
+}
+
+namespace _ostest_internal
+{
+    // Failure reported for a test which exceeded its timeout
+    constexpr const char* _timeoutExpression = "<timeout>";
+    constexpr const char* _timeoutMessage = "The test did not complete within its timeout.";
+
+    // Watches the running test for timeout until ended or destroyed
+    class _Watch
+    {
+        friend struct _Watchdog;
+        friend void _metadataCreated(const ::ostest::Metadata<unsigned int>&) noexcept;
+
+    private:
+        const ::ostest::TestInfo& info;
+        ::ostest::TestRunner& runner;  // Reports the test should it time out
+        unsigned long long start;      // Time at which the test started, in milliseconds
+        unsigned long long deadline{}; // Time by which the test must complete
+        _Watch* previous;              // Watch of the enclosing test on this thread
+        _Watch* nextWatch{};           // Next watch with a deadline
+        bool armed = false;             // Guarded by the watchdog's lock
+        bool watched = false;           // Set once armed, by the test's own thread
+        bool ended = false;
+
+        // Sets the time allowed from the start of the test. Zero disarms the watch.
+        void arm(unsigned int timeout);
+
+        // Reports the test as timed out, then ends the process
+        [[noreturn]] void abandon() const;
+
+    public:
+        _Watch(const ::ostest::TestInfo& info, ::ostest::TestRunner& runner);
+        ~_Watch() { end(); }
+
+        _Watch(const _Watch&) = delete;
+        _Watch& operator =(const _Watch&) = delete;
+
+        void end();
+    };
+
+    // Replaces the watchdog in a newly-forked process, where its thread does not exist
+    void _resetWatchdog(::ostest::TimeoutHandler handler);
+}
+#endif
@@ -1,27 +1,468 @@
 /* ostest.cpp - (c) 2016-2018 James S Renwick */
 #include "ostest-impl.hpp"
+#include "ostest-assert.hpp"
+#include "ostest-async.hpp"
+#include "ostest-timeout.hpp"
+#include "ostest-alloc.hpp"
+#include "ostest-perf.hpp"
 
 // Headers required for standard library exceptions
 #if OSTEST_STD_EXCEPTIONS
-#include <stdexcept>
+#include <exception>
 #include <string>
+#include <typeinfo>
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
 #if OSTEST_NO_ALLOC
 #error Exception support requires allocation: cannot compile with both OSTEST_STD_EXCEPTIONS and OSTEST_NO_ALLOC.
 #endif
 #endif
 
+// Headers required for thread-safe result serials & reference counts
+#if OSTEST_STD_THREADS
+#include <atomic>
+#endif
+
+// Headers required for the default timing clocks
+#if OSTEST_POSIX
+#include <time.h>
+#endif
+
+// Headers required for reading cache and state files
+#if !OSTEST_NO_ALLOC
+#include <cstdio>
+#endif
+
 
 namespace _ostest_internal
 {
-    _MetadataItem::_MetadataItem(ostest::UnitTest& test,
-        const char* name, void* item) : name(name), test(test), item(item)
+    _MetadataItem::_MetadataItem(ostest::UnitTest& test, const _MetadataName& name, void* item)
+        : name(name.name), hash(name.hash), test(test.getInfo()), item(item)
     {
-        test.addMetadata(*this);
+        this->test.addMetadata(*this);
     }
 
     _MetadataItem::~_MetadataItem() {
         test.removeMetadata(*this);
     }
+
+#if !OSTEST_NO_ALLOC
+    char* _readFile(const char* path, size_t& size)
+    {
+        std::FILE* file = std::fopen(path, "rb");
+        if (file == nullptr) return nullptr;
+
+        size_t capacity = 4096;
+        char* data = new char[capacity];
+        size = 0;
+        while (true)
+        {
+            size += std::fread(data + size, 1, capacity - size, file);
+            if (size < capacity) break;
+
+            char* newData = new char[capacity * 2];
+            for (size_t i = 0; i < size; i++) newData[i] = data[i];
+            delete[] data;
+            data = newData;
+            capacity *= 2;
+        }
+        bool failed = std::ferror(file) != 0;
+        std::fclose(file);
+
+        if (failed) {
+            delete[] data;
+            return nullptr;
+        }
+        return data;
+    }
+#endif
+
+    // Source of the serials identifying each result to its assertions
+#if OSTEST_STD_THREADS
+    static std::atomic<unsigned long> resultSerial{0};
+#else
+    static unsigned long resultSerial = 0;
+#endif
+
+#if !OSTEST_NO_ALLOC
+    // Bump allocator whose allocations are all released at once.
+    class _Arena
+    {
+    private:
+        struct Block
+        {
+            Block* previous;
+            size_t capacity;
+            size_t used;
+        };
+
+        // Released allocations, reused by allocations of the same size
+        struct FreeList
+        {
+            size_t size;
+            void* head;
+        };
+
+        static constexpr const size_t minBlockSize = 4096;
+        static constexpr const size_t maxBlockSize = 1024 * 1024;
+        static constexpr const unsigned int freeListCount = 4;
+
+        Block* current = nullptr;
+        size_t nextBlockSize = minBlockSize;
+        FreeList freeLists[freeListCount]{};
+        bool hasFree = false;
+
+    public:
+        _Arena() = default;
+        _Arena(const _Arena&) = delete;
+        _Arena& operator =(const _Arena&) = delete;
+
+        ~_Arena() { release(); }
+
+        void* allocate(size_t size, size_t align)
+        {
+            if (hasFree)
+            {
+                for (auto& list : freeLists)
+                {
+                    if (list.size != size || list.head == nullptr ||
+                        (reinterpret_cast<size_t>(list.head) & (align - 1)) != 0) continue;
+
+                    void* ptr = list.head;
+                    list.head = *static_cast<void**>(ptr);
+                    return ptr;
+                }
+            }
+
+            if (current != nullptr)
+            {
+                auto base = reinterpret_cast<size_t>(current + 1);
+                auto start = (base + current->used + align - 1) & ~(align - 1);
+
+                if (start + size <= base + current->capacity)
+                {
+                    current->used = start + size - base;
+                    return reinterpret_cast<void*>(start);
+                }
+            }
+
+            // Blocks grow geometrically, and are large enough for the allocation
+            size_t capacity = nextBlockSize;
+            while (capacity < size + align) capacity *= 2;
+            if (nextBlockSize < maxBlockSize) nextBlockSize *= 2;
+
+            auto block = reinterpret_cast<Block*>(new char[sizeof(Block) + capacity]);
+            block->previous = current;
+            block->capacity = capacity;
+            block->used = 0;
+            current = block;
+
+            return allocate(size, align);
+        }
+
+        /* Releases a single allocation of the given size, should there be a free
+           list for the size. Otherwise it remains until the arena is released. */
+        void recycle(void* ptr, size_t size) noexcept
+        {
+            if (size < sizeof(void*)) return;
+            for (auto& list : freeLists)
+            {
+                if (list.size != size && list.size != 0) continue;
+
+                list.size = size;
+                *static_cast<void**>(ptr) = list.head;
+                list.head = ptr;
+                hasFree = true;
+                return;
+            }
+        }
+
+        void release() noexcept
+        {
+            while (current != nullptr)
+            {
+                Block* previous = current->previous;
+                delete[] reinterpret_cast<char*>(current);
+                current = previous;
+            }
+        }
+    };
+
+#if OSTEST_STD_THREADS
+    // Identifies the calling thread by the address of its copy
+    static thread_local char threadTag;
+
+    // Storage for an assertion made on a thread other than that running the test
+    struct _ForeignBlock
+    {
+        _ForeignBlock* previous;
+    };
+#endif
+
+    struct _ResultData
+    {
+#if OSTEST_STD_THREADS
+        std::atomic<unsigned int> refCount{1};
+
+        // Assertions made on other threads are pushed onto 'pending', linked by
+        // their 'nextItem', and are recorded once the test has completed
+        std::atomic<const char*> runner{nullptr};
+        std::atomic<::ostest::Assertion*> pending{nullptr};
+        std::atomic<_ForeignBlock*> foreign{nullptr};
+#else
+        unsigned int refCount = 1;
+#endif
+        _Arena arena{};
+    };
+#else
+    // Statically reserved storage for temporary assertions. Tests run one after
+    // another at the same nesting depth reuse the same slots, provided nothing
+    // was allocated by the enclosing test in between. Thus a result is valid
+    // until the next test is run.
+    class _AssertionPool
+    {
+    private:
+        static constexpr const unsigned int maxDepth = 8;
+
+        struct alignas(_assertionSlotAlign) Slot {
+            char data[_assertionSlotSize];
+        };
+
+        // The number of slots taken by the largest assertion
+        static constexpr const size_t maxSlots = (sizeof(_ComparisonFailure) + _assertionSlotSize - 1) /
+            _assertionSlotSize;
+
+        Slot slots[OSTEST_ASSERTION_POOL_SIZE];
+        Slot scratch[maxSlots];
+        size_t used = 0;
+
+        unsigned int depth = 0;
+        size_t runStart[maxDepth]{};
+        size_t runEnd[maxDepth]{};
+        bool hasRun[maxDepth]{};
+
+    public:
+        void beginRun()
+        {
+            if (depth < maxDepth)
+            {
+                // Reuse the slots of the previous test at this depth
+                if (hasRun[depth] && used == runEnd[depth]) used = runStart[depth];
+                else runStart[depth] = used;
+
+                hasRun[depth] = true;
+                if (depth + 1 < maxDepth) hasRun[depth + 1] = false;
+            }
+            depth++;
+        }
+
+        void endRun()
+        {
+            depth--;
+            if (depth < maxDepth) runEnd[depth] = used;
+        }
+
+        /* Gets consecutive free slots holding the given size, or nullptr if the pool is full. */
+        void* allocate(size_t size)
+        {
+            size_t count = (size + _assertionSlotSize - 1) / _assertionSlotSize;
+            if (OSTEST_ASSERTION_POOL_SIZE - used < count) return nullptr;
+
+            used += count;
+            return slots[used - count].data;
+        }
+
+        /* Releases a slot, should it be the most recently allocated. */
+        void release(void* ptr) {
+            if (used != 0 && ptr == slots[used - 1].data) used--;
+        }
+
+        /* Gets storage for an assertion which will not be recorded. */
+        void* getScratch() { return scratch[0].data; }
+
+        bool isScratch(const void* ptr) const { return ptr == scratch[0].data; }
+    };
+
+    static _AssertionPool assertionPool{};
+    static ostest::AssertionPoolPolicy assertionPoolPolicy = ostest::AssertionPoolPolicy::KeepFirst;
+#endif
+
+    static ostest::RetentionPolicy retentionPolicy = ostest::RetentionPolicy::KeepAll;
+    static unsigned int retainedPasses = 0;
+
+#if !OSTEST_NO_ALLOC
+    // Gets the size of an assertion of the given kind, or zero if not known
+    static size_t _assertionSize(ostest::AssertionKind kind) noexcept
+    {
+        switch (kind)
+        {
+            case ostest::AssertionKind::Basic: return sizeof(ostest::Assertion);
+            case ostest::AssertionKind::Each: return sizeof(ostest::EachAssertion);
+            case ostest::AssertionKind::Custom: return 0;
+            default: return sizeof(_ComparisonAssertion);
+        }
+    }
+#endif
+
+    // Writes characters into a fixed-size buffer, truncating should it fill
+    struct _MessageWriter
+    {
+        char* ptr;
+        char* const end;
+
+        void put(char c) { if (ptr != end) *ptr++ = c; }
+        void put(const char* str) { for (; *str != '\0'; str++) put(*str); }
+
+        void putUnsigned(unsigned long long value, unsigned int base = 10)
+        {
+            char digits[24];
+            size_t count = 0;
+            do {
+                digits[count++] = "0123456789abcdef"[value % base];
+                value /= base;
+            } while (value != 0);
+            while (count != 0) put(digits[--count]);
+        }
+
+        void putSigned(long long value)
+        {
+            if (value < 0) put('-');
+            putUnsigned(value < 0 ? 0ull - static_cast<unsigned long long>(value) :
+                static_cast<unsigned long long>(value));
+        }
+
+        // Writes up to six decimal places, switching to an exponent for
+        // large and small values
+        void putFloating(double value)
+        {
+            if (value != value) return put("nan");
+            if (value < 0) { put('-'); value = -value; }
+            if (value > 1.7976931348623157e308) return put("inf");
+
+            int exponent = 0;
+            if (value >= 1e12 || (value != 0 && value < 1e-4))
+            {
+                while (value >= 10) { value /= 10; exponent++; }
+                while (value < 1) { value *= 10; exponent--; }
+            }
+
+            auto scaled = static_cast<unsigned long long>(value * 1e6 + 0.5);
+            if (exponent != 0 && scaled >= 10000000ull) { scaled /= 10; exponent++; }
+            putUnsigned(scaled / 1000000ull);
+
+            unsigned long long fraction = scaled % 1000000ull;
+            if (fraction != 0)
+            {
+                put('.');
+                for (unsigned long long digit = 100000ull; fraction != 0; digit /= 10)
+                {
+                    put(static_cast<char>('0' + fraction / digit));
+                    fraction %= digit;
+                }
+            }
+            if (exponent != 0)
+            {
+                put('e');
+                putSigned(exponent);
+            }
+        }
+
+        void putOperand(_OperandKind kind, const _OperandValue& value)
+        {
+            switch (kind)
+            {
+                case _OperandKind::boolean: return put(value.u != 0 ? "true" : "false");
+                case _OperandKind::character:
+                    if (value.s >= ' ' && value.s <= '~')
+                    {
+                        put('\'');
+                        put(static_cast<char>(value.s));
+                        return put('\'');
+                    }
+                    return putSigned(value.s);
+                case _OperandKind::signedInt: return putSigned(value.s);
+                case _OperandKind::unsignedInt: return putUnsigned(value.u);
+                case _OperandKind::floating: return putFloating(value.f);
+                case _OperandKind::pointer:
+                    put("0x");
+                    return putUnsigned(reinterpret_cast<size_t>(value.p), 16);
+                case _OperandKind::null: return put("nullptr");
+                case _OperandKind::none: return;
+            }
+        }
+    };
+
+    const char* _ComparisonFailure::getComparisonMessage(const char* op, const char* failMsg) const
+    {
+        if (formatted) return storage.message;
+        if (kinds[0] == _OperandKind::none || kinds[1] == _OperandKind::none) return failMsg;
+
+        // Copy the operands out before overwriting them with the message
+        _OperandValue a = storage.operands[0], b = storage.operands[1];
+        _MessageWriter writer{storage.message, storage.message + messageSize - 1};
+        writer.put("Expected ");
+        writer.putOperand(kinds[0], a);
+        writer.put(' ');
+        writer.put(op);
+        writer.put(' ');
+        writer.putOperand(kinds[1], b);
+        writer.put('.');
+        *writer.ptr = '\0';
+
+        formatted = true;
+        return storage.message;
+    }
+
+#if OSTEST_STD_EXCEPTIONS
+    // Demangles simple Itanium ABI class names, such as "St13runtime_error"
+    // or "N2ns5ErrorE", without allocating. Returns false for other names.
+    static bool _demangle(_MessageWriter& writer, const char* name)
+    {
+        bool nested = *name == 'N';
+        if (nested) name++;
+
+        bool first = true;
+        if (name[0] == 'S' && name[1] == 't')
+        {
+            writer.put("std");
+            first = false;
+            name += 2;
+        }
+        do
+        {
+            if (*name < '0' || *name > '9') return false;
+            size_t length = 0;
+            for (; *name >= '0' && *name <= '9'; name++) length = length * 10 + static_cast<size_t>(*name - '0');
+
+            if (!first) writer.put("::");
+            for (; length != 0; length--, name++)
+            {
+                if (*name == '\0') return false;
+                writer.put(*name);
+            }
+            first = false;
+        }
+        while (nested && *name != 'E');
+
+        if (nested) name++;
+        return *name == '\0';
+    }
+
+    /* [internal] Writes the given type name, demangled where possible. */
+    static void _putTypeName(_MessageWriter& writer, const char* name)
+    {
+#if defined(__GNUC__)
+        // Types with internal linkage may be marked with '*'
+        if (*name == '*') name++;
+
+        char* start = writer.ptr;
+        if (_demangle(writer, name)) return;
+        writer.ptr = start;
+#endif
+        writer.put(name);
+    }
+#endif
 }
 
 
@@ -38,28 +479,95 @@ namespace ostest
 #else
     extern const bool ostest_no_alloc = false;
 #endif
+#if OSTEST_STD_THREADS
+    extern const bool ostest_std_threads = true;
+#else
+    extern const bool ostest_std_threads = false;
+#endif
+#if OSTEST_POSIX
+    extern const bool ostest_posix = true;
+#else
+    extern const bool ostest_posix = false;
+#endif
+#if OSTEST_SECTION_REGISTRATION
+    extern const bool ostest_section_registration = true;
+#else
+    extern const bool ostest_section_registration = false;
+#endif
+#if OSTEST_TRACK_ALLOCATIONS
+    extern const bool ostest_track_allocations = true;
+#else
+    extern const bool ostest_track_allocations = false;
+#endif
+#if OSTEST_PERF_COUNTERS
+    extern const bool ostest_perf_counters = true;
+#else
+    extern const bool ostest_perf_counters = false;
+#endif
 
 
 #if OSTEST_STD_EXCEPTIONS
 
-    /* Class representing an assertion that an exception has not been thrown. */
-    class NoExceptionAssertion : public Assertion
+    /* Class representing an assertion that an exception has not been thrown.
+       The exception message is copied into a buffer following the assertion,
+       with space before it into which the full message is formatted once
+       requested. */
+    class NoExceptionAssertion : public CustomAssertion
     {
     private:
-        const char* exceptionMsg;
+        const char* typeName;     // The implementation's name for the exception type, or nullptr
+        unsigned long whatOffset; // The offset of the exception message within the buffer
+        unsigned long whatLength;
+        mutable bool formatted = false;
+
     public:
-        explicit NoExceptionAssertion(const std::exception& exception,
-            const TestInfo& test, bool temp=true);
-        virtual ~NoExceptionAssertion();
+        /* Creates a new arena-allocated assertion, which must be given at least
+           'allocationSize' bytes. */
+        NoExceptionAssertion(const char* what, unsigned long whatLength,
+            const char* typeName, const TestInfo& test);
 
-        NoExceptionAssertion(NoExceptionAssertion&& other);
         NoExceptionAssertion(const NoExceptionAssertion& other) = delete;
         NoExceptionAssertion& operator=(const NoExceptionAssertion& other) = delete;
 
-    public:
+        /* Gets the length of the given exception message, truncated to 816 characters. */
+        static unsigned long messageLength(const char* what);
+
+        /* Gets the size of the allocation needed for an assertion of the given exception. */
+        static unsigned long allocationSize(unsigned long whatLength, const char* typeName);
+
+    private:
+        static unsigned long headerSize(const char* typeName);
+        const char* format() const;
+
+        inline char* buffer() const {
+            return reinterpret_cast<char*>(const_cast<NoExceptionAssertion*>(this) + 1);
+        }
+
         /* Gets the exception message. */
-        virtual const char* getMessage() const override;
+        static const char* message(const CustomAssertion& assertion);
     };
+
+    // Gets the implementation's name for the dynamic type of the exception
+    static const char* exceptionTypeName(const std::exception& exception)
+    {
+#if defined(__GXX_RTTI) || defined(_CPPRTTI)
+        return typeid(exception).name();
+#else
+        (void)exception;
+        return nullptr;
+#endif
+    }
+
+    // Gets the implementation's name for the type of the exception being handled
+    static const char* currentExceptionTypeName()
+    {
+#if defined(__GNUC__)
+        auto type = abi::__cxa_current_exception_type();
+        return type != nullptr ? type->name() : nullptr;
+#else
+        return nullptr;
+#endif
+    }
 #endif
 
 
@@ -67,70 +575,115 @@ namespace ostest
     TestSuite::~TestSuite() { }
 
 
-    // Tests for string equality
-    static bool streq(const char* s1, const char* s2)
+#if OSTEST_POSIX
+    static unsigned long long readClock(clockid_t clock)
     {
-        for (unsigned long int i = 0; ; i++)
-        {
-            if (s1[i] != s2[i]) return false;
-            else if (s1[i] == s2[i] && s1[i] == '\0') return true;
-        }
-        return false;
+        timespec time{};
+        clock_gettime(clock, &time);
+        return static_cast<unsigned long long>(time.tv_sec) * 1000000000ull +
+            static_cast<unsigned long long>(time.tv_nsec);
     }
 
+    static unsigned long long defaultWallClock() {
+        return readClock(CLOCK_MONOTONIC);
+    }
+    static unsigned long long defaultCpuClock() {
+        return readClock(CLOCK_THREAD_CPUTIME_ID);
+    }
+#else
+    static constexpr TimingClock defaultWallClock = nullptr;
+    static constexpr TimingClock defaultCpuClock = nullptr;
+#endif
+
+    static TimingClock wallClock = defaultWallClock;
+    static TimingClock cpuClock = defaultCpuClock;
+
+    void setTimingClocks(TimingClock wall, TimingClock cpu) noexcept
+    {
+        wallClock = wall;
+        cpuClock = cpu;
+    }
+
+    void resetTimingClocks() noexcept {
+        setTimingClocks(defaultWallClock, defaultCpuClock);
+    }
+
+    void getTimingClocks(TimingClock& wall, TimingClock& cpu) noexcept
+    {
+        wall = wallClock;
+        cpu = cpuClock;
+    }
+
+    // Reads both timing clocks
+    static TestDuration readTimingClocks()
+    {
+        return TestDuration{wallClock ? wallClock() : 0, cpuClock ? cpuClock() : 0};
+    }
+
+    // Gets the time elapsed between two clock readings
+    static TestDuration elapsed(const TestDuration& start, const TestDuration& end)
+    {
+        return TestDuration{end.wallTime - start.wallTime, end.cpuTime - start.cpuTime};
+    }
+
+
     // Typedef for convenience
     typedef _ostest_internal::_MetadataItem MetadataItem;
 
 
-    void UnitTest::addMetadata(MetadataItem& item, bool user)
+    void TestInfo::addMetadata(MetadataItem& item, bool user) const
     {
-        MetadataItem* root = user ? firstUserMetadataItem :
-            firstInternalMetadataItem;
+        MetadataItem*& root = user ? firstUserMetadataItem : firstInternalMetadataItem;
+        MetadataItem*& last = user ? finalUserMetadataItem : finalInternalMetadataItem;
 
-        if (root == nullptr) {
-            (user ? firstUserMetadataItem : firstInternalMetadataItem) = &item;
-        }
-        else
-        {
-            MetadataItem* last = root;
-            while (last->nextItem != nullptr) last = last->nextItem;
-            last->nextItem = &item;
-        }
+        item.nextItem = nullptr;
+        if (root == nullptr) root = &item;
+        else last->nextItem = &item;
+        last = &item;
     }
 
-    void UnitTest::removeMetadata(MetadataItem& item, bool user)
+    void TestInfo::removeMetadata(MetadataItem& item, bool user) const
     {
-        MetadataItem* prev = user ? firstUserMetadataItem :
-            firstInternalMetadataItem;
+        MetadataItem*& root = user ? firstUserMetadataItem : firstInternalMetadataItem;
+        MetadataItem*& last = user ? finalUserMetadataItem : finalInternalMetadataItem;
 
-        if (prev == &item) {
-            (user ? firstUserMetadataItem : firstInternalMetadataItem)
-                = item.nextItem;
-            return;
-        }
-        while (prev != nullptr && prev->nextItem != &item) {
-            prev = prev->nextItem;
+        MetadataItem* prev = nullptr;
+        if (root != &item)
+        {
+            prev = root;
+            while (prev != nullptr && prev->nextItem != &item) {
+                prev = prev->nextItem;
+            }
+            if (prev == nullptr) return;
         }
-        if (prev == nullptr) return;
+
+        if (prev == nullptr) root = item.nextItem;
         else prev->nextItem = item.nextItem;
+        if (last == &item) last = prev;
     }
 
-    void* UnitTest::getMetadataRaw(const char* name, bool user) const
+    void* TestInfo::getMetadataRaw(const char* name, unsigned int hash, bool user) const
     {
         MetadataItem* item = user ? firstUserMetadataItem :
             firstInternalMetadataItem;
 
+        // Only compare names when their hashes match
         while (item != nullptr)
         {
-            if (streq(item->name, name)) return item->item;
+            if (item->hash == hash && _ostest_internal::_streq(item->name, name)) return item->item;
             else item = item->nextItem;
         }
         return nullptr;
     }
 
+    void* UnitTest::getMetadataRaw(const char* name, unsigned int hash) const
+    {
+        return info->getMetadataRaw(name, hash);
+    }
+
     // Creates a new assertion
     Assertion::Assertion(const char* expr, const char* file, int line, bool tmp)
-        : temporary(tmp), expression(expr), file(file), line(line) { }
+        : expression(expr), file(file), line(line), result(true), arena(false), temporary(tmp) { }
 
 // Only define this overload if allocation enabled - prevents use of features which
 // require allocation when allocation not enabled
@@ -139,62 +692,286 @@ namespace ostest
         const char* file, int line, bool tmp) : Assertion(expr, file, line, tmp) { }
 #endif
 
+    Assertion::Assertion(const char* expr, _ostest_internal::_arenaalloc_tag,
+        const char* file, int line) : Assertion(expr, file, line, true)
+    {
+        this->arena = true;
+    }
+
+    // The operator and failure message of each kind of assertion
+    static constexpr const struct { const char* op; const char* failMsg; } assertionMessages[] = {
+        {"",   "The assertion failed."},
+        {"==", "Expected zero value."},
+        {"!=", "Expected non-zero value."},
+        {"==", "Expected equal values."},
+        {"!=", "Expected non-equal values."},
+        {"<",  "The first value was not less than the second."},
+        {">",  "The first value was not greater than the second."},
+        {"<=", "The first value was not less than or equal to the second."},
+        {">=", "The first value was not greater than or equal to the second."},
+        {"",   "The assertion failed."},
+    };
+
+    const char* Assertion::getMessage() const
+    {
+        if (kind == AssertionKind::Custom)
+        {
+            auto& custom = static_cast<const CustomAssertion&>(*this);
+            return custom.message(custom);
+        }
+        if (result) return emptyMsg;
+
+        if (kind == AssertionKind::Each) {
+            return static_cast<const EachAssertion&>(*this).getEachMessage();
+        }
+
+        auto& messages = assertionMessages[static_cast<unsigned int>(kind)];
+        if (kind == AssertionKind::Basic) return messages.failMsg;
+        // Comparisons are only recorded as failed through their failure records
+        return static_cast<const _ostest_internal::_ComparisonFailure&>(*this)
+            .getComparisonMessage(messages.op, messages.failMsg);
+    }
+
+    void Assertion::destroy(Assertion* assertion)
+    {
+        if (assertion->kind == AssertionKind::Custom)
+        {
+            auto custom = static_cast<CustomAssertion*>(assertion);
+            if (custom->destroyer != nullptr) return custom->destroyer(custom);
+        }
+        delete assertion;
+    }
+
+    void EachAssertion::restart(UnitTest& test)
+    {
+        evaluations = failures = 0;
+        formattedAt = 0;
+        Assertion::evaluate(test, true);
+    }
+
+    void EachAssertion::fail(UnitTest& test, unsigned long long index)
+    {
+        // Only the first failure changes the recorded outcome
+        if (failures++ == 0)
+        {
+            firstFailure = index;
+            Assertion::evaluate(test, false);
+        }
+        finalFailure = index;
+    }
+
+    const char* EachAssertion::getEachMessage() const
+    {
+        // Passing evaluations may follow formatting, so check the count
+        if (formattedAt == evaluations) return message;
+
+        _ostest_internal::_MessageWriter writer{message, message + messageSize - 1};
+        writer.put("Failed ");
+        writer.putUnsigned(failures);
+        writer.put(" of ");
+        writer.putUnsigned(evaluations);
+        writer.put(failures == 1 ? " evaluations, at index " : " evaluations, first at index ");
+        writer.putUnsigned(firstFailure);
+        if (failures != 1)
+        {
+            writer.put(", final at index ");
+            writer.putUnsigned(finalFailure);
+        }
+        writer.put('.');
+        *writer.ptr = '\0';
+
+        formattedAt = evaluations;
+        return message;
+    }
+
     bool Assertion::evaluate(UnitTest& test, bool result)
     {
+        return evaluate(test.result, result);
+    }
+
+#if OSTEST_STD_THREADS
+    bool Assertion::isForeignThread(const UnitTest& test) noexcept
+    {
+        return test.result.isForeignThread();
+    }
+#endif
+
+    void* Assertion::allocateTemporary(UnitTest& test, _ostest_internal::size_t size,
+        _ostest_internal::size_t align)
+    {
+        return test.allocateTemporary(size, align);
+    }
+
+    bool Assertion::evaluate(TestResult& testResult, bool result)
+    {
+#if OSTEST_STD_THREADS
+        if (testResult.isForeignThread()) return testResult.addForeign(*this, result);
+#endif
+        auto& summary = testResult.summary;
+
         // Reset state in case values already set by previous invocation.
-        // (Linked list state should have been reset by TestResult destructor.)
+        bool previous = this->result;
         this->result = result;
 
+#if OSTEST_NO_ALLOC
+        // Assertions which did not fit in the pool are not recorded
+        if (this->arena && _ostest_internal::assertionPool.isScratch(this))
+        {
+            if (!result) summary.droppedFailure = true;
+            if (_ostest_internal::assertionPoolPolicy == AssertionPoolPolicy::DropWithCounter) {
+                summary.droppedCount++;
+            }
+            return result;
+        }
+#endif
+
         // This function always inserts the assertion at the end of the list.
-        // Thus if already present in list, update existing list pointers.
-        if (this->nextItem != nullptr) this->nextItem->prevItem = this->prevItem;
-        if (this->prevItem != nullptr) this->prevItem->nextItem = this->nextItem;
+        // Thus if already present in list, remove it and its previous outcome.
+        // (Links to the list of any other result are stale, and are ignored.)
+        if (this->owner == summary.serial)
+        {
+            if (previous)
+            {
+                summary.passCount--;
+                if (summary.retention != RetentionPolicy::KeepAll && (this->arena || this->temporary)) {
+                    summary.keptPasses--;
+                }
+            }
+            else
+            {
+                summary.failCount--;
 
-        // Update first item
-        if (this->prevItem == nullptr && this->nextItem != nullptr) {
-            test.result.firstItem = this->nextItem;
+                // Find the failures either side of this assertion
+                if (summary.firstFailure == this)
+                {
+                    Assertion* next = this->nextItem;
+                    while (next != nullptr && next->passed()) next = next->nextItem;
+                    summary.firstFailure = next;
+                }
+                if (summary.finalFailure == this)
+                {
+                    Assertion* prev = this->prevItem;
+                    while (prev != nullptr && prev->passed()) prev = prev->prevItem;
+                    summary.finalFailure = prev;
+                }
+            }
+
+            if (summary.oldestPass == this) summary.oldestPass = this->nextItem;
+            if (this->prevItem != nullptr) this->prevItem->nextItem = this->nextItem;
+            else testResult.firstItem = this->nextItem;
+            if (this->nextItem != nullptr) this->nextItem->prevItem = this->prevItem;
+            else testResult.finalItem = this->prevItem;
+        }
+
+        // Passing temporary assertions are only counted under a restricted policy
+        bool restricted = result && summary.retention != RetentionPolicy::KeepAll &&
+            (this->arena || this->temporary);
+        if (restricted && (summary.retention == RetentionPolicy::KeepFailures || summary.passLimit == 0))
+        {
+            summary.passCount++;
+            summary.releasedCount++;
+            testResult.release(*this);
+            return result;
         }
 
         // Add to end of list
-        this->prevItem = nullptr;
+        this->owner = summary.serial;
+        this->prevItem = testResult.finalItem;
         this->nextItem = nullptr;
 
-        // Update list first and final pointers
-        if (test.result.firstItem == nullptr) test.result.firstItem = this;
-        if (test.result.finalItem != nullptr && test.result.finalItem != this)
+        if (testResult.finalItem != nullptr) testResult.finalItem->nextItem = this;
+        else testResult.firstItem = this;
+        testResult.finalItem = this;
+
+        // Update summary
+        if (result) summary.passCount++;
+        else
         {
-            this->prevItem = test.result.finalItem;
-            test.result.finalItem->nextItem = this;
+            summary.failCount++;
+            if (summary.firstFailure == nullptr) summary.firstFailure = this;
+            summary.finalFailure = this;
         }
-        test.result.finalItem = this;
-
+        if (restricted) testResult.retainPass(*this);
         return result;
     }
 
+    void TestResult::release(Assertion& assertion)
+    {
+        assertion.owner = 0;
+#if OSTEST_TRACK_ALLOCATIONS
+        _ostest_internal::_AllocationPause pause{};
+#endif
 #if OSTEST_NO_ALLOC
-    TestResult::TestResult() = default;
-    TestResult::TestResult(const TestResult&) = default;
-    TestResult::TestResult(TestResult&&) = default;
-    TestResult& TestResult::operator =(const TestResult&) = default;
-    TestResult& TestResult::operator =(TestResult&&) = default;
-    TestResult::~TestResult() = default;
+        if (assertion.arena) _ostest_internal::assertionPool.release(&assertion);
 #else
-    TestResult::TestResult() : refCount(new unsigned int(1))
+        if (assertion.arena)
+        {
+            size_t size = _ostest_internal::_assertionSize(assertion.kind);
+            if (shared != nullptr && size != 0) shared->arena.recycle(&assertion, size);
+        }
+        else if (assertion.temporary) Assertion::destroy(&assertion);
+#endif
+    }
+
+    void TestResult::retainPass(Assertion& assertion)
     {
+        if (summary.oldestPass == nullptr) summary.oldestPass = &assertion;
+        if (++summary.keptPasses <= summary.passLimit) return;
+
+        // Release the oldest kept pass
+        Assertion* oldest = summary.oldestPass;
+        while (!oldest->result || !(oldest->arena || oldest->temporary)) oldest = oldest->nextItem;
+
+        if (oldest->prevItem != nullptr) oldest->prevItem->nextItem = oldest->nextItem;
+        else this->firstItem = oldest->nextItem;
+        if (oldest->nextItem != nullptr) oldest->nextItem->prevItem = oldest->prevItem;
+        else this->finalItem = oldest->prevItem;
+
+        summary.oldestPass = oldest->nextItem;
+        summary.keptPasses--;
+        summary.releasedCount++;
+        release(*oldest);
+    }
 
+#if OSTEST_NO_ALLOC
+    TestResult::TestResult() {
+        this->summary.serial = ++_ostest_internal::resultSerial;
     }
+    TestResult::TestResult(const TestResult&) = default;
+    TestResult& TestResult::operator =(const TestResult&) = default;
+    TestResult::~TestResult() = default;
 
-    TestResult::TestResult(TestResult&& other)
+    void* TestResult::allocate(_ostest_internal::size_t size, _ostest_internal::size_t)
     {
-        this->firstItem = other.firstItem;
-        this->finalItem = other.finalItem;
-        this->itemCount = other.itemCount;
-        this->refCount  = other.refCount;
+        void* where = _ostest_internal::assertionPool.allocate(size);
+        if (where != nullptr) return where;
 
-        other.firstItem = nullptr;
-        other.finalItem = nullptr;
-        other.itemCount = 0;
-        other.refCount = nullptr;
+        // Replace the first passed assertion recorded from the pool, should one slot suffice
+        if (_ostest_internal::assertionPoolPolicy == AssertionPoolPolicy::KeepFailures &&
+            size <= _ostest_internal::_assertionSlotSize)
+        {
+            for (Assertion* item = this->firstItem; item != nullptr; item = item->nextItem)
+            {
+                if (!item->arena || !item->passed()) continue;
+
+                if (this->summary.oldestPass == item) this->summary.oldestPass = item->nextItem;
+                if (this->summary.retention != RetentionPolicy::KeepAll) this->summary.keptPasses--;
+                if (item->prevItem != nullptr) item->prevItem->nextItem = item->nextItem;
+                else this->firstItem = item->nextItem;
+                if (item->nextItem != nullptr) item->nextItem->prevItem = item->prevItem;
+                else this->finalItem = item->prevItem;
+
+                item->owner = 0;
+                this->summary.passCount--;
+                return item;
+            }
+        }
+        return _ostest_internal::assertionPool.getScratch();
+    }
+#else
+    TestResult::TestResult() : shared(new _ostest_internal::_ResultData())
+    {
+        this->summary.serial = ++_ostest_internal::resultSerial;
     }
 
     TestResult::TestResult(const TestResult& copy)
@@ -202,9 +979,15 @@ namespace ostest
         this->firstItem = copy.firstItem;
         this->finalItem = copy.finalItem;
         this->itemCount = copy.itemCount;
-        this->refCount  = copy.refCount;
-
-        if (refCount != nullptr) { (*refCount)++; }
+        this->shared    = copy.shared;
+        this->timings   = copy.timings;
+        this->benchmarkStats = copy.benchmarkStats;
+        this->allocationStats = copy.allocationStats;
+        this->allocationsTracked = copy.allocationsTracked;
+        this->perfCounters = copy.perfCounters;
+        this->summary   = copy.summary;
+
+        if (shared != nullptr) { shared->refCount++; }
     }
 
     TestResult& TestResult::operator =(const TestResult& other)
@@ -216,88 +999,238 @@ namespace ostest
         this->firstItem = other.firstItem;
         this->finalItem = other.finalItem;
         this->itemCount = other.itemCount;
-        this->refCount  = other.refCount;
-
-        if (refCount != nullptr) { (*refCount)++; }
-        return *this;
-    }
-
-    TestResult& TestResult::operator =(TestResult&& other)
-    {
-        if (&other == this) return *this; // Do nothing if same object
-
-        auto firstItem = this->firstItem;
-        auto finalItem = this->finalItem;
-        auto itemCount = this->itemCount;
-        auto refCount = this->refCount;
-
-        this->firstItem = other.firstItem;
-        this->finalItem = other.finalItem;
-        this->itemCount = other.itemCount;
-        this->refCount  = other.refCount;
-
-        other.firstItem = firstItem;
-        other.finalItem = finalItem;
-        other.itemCount = itemCount;
-        other.refCount = refCount;
-
+        this->shared    = other.shared;
+        this->timings   = other.timings;
+        this->benchmarkStats = other.benchmarkStats;
+        this->allocationStats = other.allocationStats;
+        this->allocationsTracked = other.allocationsTracked;
+        this->perfCounters = other.perfCounters;
+        this->summary   = other.summary;
+
+        if (shared != nullptr) { shared->refCount++; }
         return *this;
     }
 
     void TestResult::destroy()
     {
         // This is the case upon move
-        if (this->refCount != nullptr)
+        if (this->shared != nullptr)
         {
-            this->refCount[0]--;
-
-            if (*this->refCount == 0)
+            if (--this->shared->refCount == 0)
             {
                 Assertion *next = this->firstItem;
                 while (next != nullptr)
                 {
+                    // Assertions made once may since be recorded by a newer result,
+                    // their links then belonging to its list
+                    if (next->owner != this->summary.serial) break;
                     Assertion* tmp = next->nextItem;
 
-                    // Delete or reset
-                    if (next->temporary) delete next;
+                    // Delete or reset. Arena assertions are released with the arena.
+                    if (next->arena) { }
+                    else if (next->temporary) Assertion::destroy(next);
                     else next->prevItem = next->nextItem = nullptr;
 
                     next = tmp; // Return next assertion
                 }
+#if OSTEST_STD_THREADS
+                // Release assertions queued by threads which outlived the test
+                for (Assertion* item = shared->pending.load(); item != nullptr;)
+                {
+                    Assertion* tmp = item->nextItem;
+                    if (!item->arena && item->temporary) Assertion::destroy(item);
+                    item = tmp;
+                }
+                for (auto block = shared->foreign.load(); block != nullptr;)
+                {
+                    auto previous = block->previous;
+                    delete[] reinterpret_cast<char*>(block);
+                    block = previous;
+                }
+#endif
+                delete this->shared;
             }
         }
     }
 
+    void* TestResult::allocate(_ostest_internal::size_t size, _ostest_internal::size_t align)
+    {
+        if (shared == nullptr) return nullptr;
+#if OSTEST_TRACK_ALLOCATIONS
+        _ostest_internal::_AllocationPause pause{};
+#endif
+#if OSTEST_STD_THREADS
+        // The arena belongs to the thread running the test
+        if (isForeignThread())
+        {
+            using _ostest_internal::_ForeignBlock;
+            size_t offset = (sizeof(_ForeignBlock) + align - 1) & ~(align - 1);
+            auto block = reinterpret_cast<_ForeignBlock*>(new char[offset + size]);
+
+            block->previous = shared->foreign.load(std::memory_order_relaxed);
+            while (!shared->foreign.compare_exchange_weak(block->previous, block,
+                std::memory_order_relaxed)) { }
+            return reinterpret_cast<char*>(block) + offset;
+        }
+#endif
+        return shared->arena.allocate(size, align);
+    }
+
+#if OSTEST_STD_THREADS
+    bool TestResult::isForeignThread() const noexcept
+    {
+        if (shared == nullptr) return false;
+        const char* runner = shared->runner.load(std::memory_order_relaxed);
+        return runner != nullptr && runner != &_ostest_internal::threadTag;
+    }
+
+    void TestResult::beginThreads() noexcept
+    {
+        if (shared != nullptr) shared->runner.store(&_ostest_internal::threadTag, std::memory_order_relaxed);
+    }
+
+    void TestResult::endThreads()
+    {
+        if (shared == nullptr) return;
+        shared->runner.store(nullptr, std::memory_order_relaxed);
+
+        // Record the queued assertions in the order in which they were made
+        Assertion* reversed = nullptr;
+        for (Assertion* item = shared->pending.exchange(nullptr, std::memory_order_acquire); item != nullptr;)
+        {
+            Assertion* next = item->nextItem;
+            item->nextItem = reversed;
+            reversed = item;
+            item = next;
+        }
+        while (reversed != nullptr)
+        {
+            Assertion* next = reversed->nextItem;
+            reversed->evaluate(*this, reversed->result);
+            reversed = next;
+        }
+    }
+
+    bool TestResult::addForeign(Assertion& assertion, bool result)
+    {
+        // Assertions made with '_ONCE' may be shared between threads, so are
+        // recorded as a copy. Any other assertion belongs to its thread.
+        Assertion* item = &assertion;
+        if (!assertion.arena && !assertion.temporary)
+        {
+            item = new (allocate(sizeof(Assertion), alignof(Assertion)))
+                Assertion(assertion.expression, _ostest_internal::_arenaalloc_tag{}, assertion.file, assertion.line);
+        }
+        item->result = result;
+
+        item->nextItem = shared->pending.load(std::memory_order_relaxed);
+        while (!shared->pending.compare_exchange_weak(item->nextItem, item,
+            std::memory_order_release, std::memory_order_relaxed)) { }
+        return result;
+    }
+#endif
+
     TestResult::~TestResult()
     {
         this->destroy();
     }
 #endif
 
-    bool TestResult::succeeded() const
+    TestResult::TestResult(TestResult&& other)
     {
-        for (auto& assertion : AssertionIterator(this->firstItem)) {
-            if (!assertion.passed()) return false;
-        }
-        return true;
+        this->firstItem = other.firstItem;
+        this->finalItem = other.finalItem;
+        this->itemCount = other.itemCount;
+        this->shared    = other.shared;
+        this->timings   = other.timings;
+        this->benchmarkStats = other.benchmarkStats;
+        this->allocationStats = other.allocationStats;
+        this->allocationsTracked = other.allocationsTracked;
+        this->perfCounters = other.perfCounters;
+        this->summary   = other.summary;
+
+        other.firstItem = nullptr;
+        other.finalItem = nullptr;
+        other.itemCount = 0;
+        other.shared = nullptr;
+        other.timings = TestTimings{};
+        other.benchmarkStats = BenchmarkStats{};
+        other.allocationStats = AllocationStats{};
+        other.allocationsTracked = false;
+        other.perfCounters = PerfCounters{};
+        other.summary = _ostest_internal::_ResultSummary{};
     }
 
-    const Assertion* TestResult::getFirstFailure() const
+    TestResult& TestResult::operator =(TestResult&& other)
     {
-        for (auto& assertion : AssertionIterator(this->firstItem)) {
-            if (!assertion.passed()) return &assertion;
-        }
-        return nullptr;
+        if (&other == this) return *this; // Do nothing if same object
+
+        auto firstItem = this->firstItem;
+        auto finalItem = this->finalItem;
+        auto itemCount = this->itemCount;
+        auto shared = this->shared;
+        auto timings = this->timings;
+        auto benchmarkStats = this->benchmarkStats;
+        auto allocationStats = this->allocationStats;
+        auto allocationsTracked = this->allocationsTracked;
+        auto perfCounters = this->perfCounters;
+        auto summary = this->summary;
+
+        this->firstItem = other.firstItem;
+        this->finalItem = other.finalItem;
+        this->itemCount = other.itemCount;
+        this->shared    = other.shared;
+        this->timings   = other.timings;
+        this->benchmarkStats = other.benchmarkStats;
+        this->allocationStats = other.allocationStats;
+        this->allocationsTracked = other.allocationsTracked;
+        this->perfCounters = other.perfCounters;
+        this->summary   = other.summary;
+
+        other.firstItem = firstItem;
+        other.finalItem = finalItem;
+        other.itemCount = itemCount;
+        other.shared = shared;
+        other.timings = timings;
+        other.benchmarkStats = benchmarkStats;
+        other.allocationStats = allocationStats;
+        other.allocationsTracked = allocationsTracked;
+        other.perfCounters = perfCounters;
+        other.summary = summary;
+
+        return *this;
     }
 
-    const Assertion* TestResult::getFinalFailure() const
+    void setAssertionPoolPolicy(AssertionPoolPolicy policy) noexcept
     {
-        const Assertion* final = nullptr;
+#if OSTEST_NO_ALLOC
+        _ostest_internal::assertionPoolPolicy = policy;
+#else
+        (void)policy;
+#endif
+    }
 
-        for (auto& assertion : AssertionIterator(this->firstItem)) {
-            if (!assertion.passed()) final = &assertion;
-        }
-        return final;
+    void setRetentionPolicy(RetentionPolicy policy, unsigned int lastPasses) noexcept
+    {
+        _ostest_internal::retentionPolicy = policy;
+        _ostest_internal::retainedPasses = lastPasses;
+    }
+
+    RetentionPolicy getRetentionPolicy() noexcept {
+        return _ostest_internal::retentionPolicy;
+    }
+
+    unsigned int getRetainedPasses() noexcept {
+        return _ostest_internal::retainedPasses;
+    }
+
+    AssertionPoolPolicy getAssertionPoolPolicy() noexcept
+    {
+#if OSTEST_NO_ALLOC
+        return _ostest_internal::assertionPoolPolicy;
+#else
+        return AssertionPoolPolicy::KeepFirst;
+#endif
     }
 
     SuiteUniquePtr::SuiteUniquePtr(SuiteInfo& info)
@@ -308,8 +1241,15 @@ namespace ostest
     }
 
 
-    SuiteInfo::SuiteInfo(void* ptr, ctor constructor, dtor destructor, const char* name)
-        : ptr(ptr), constructor(constructor), destructor(destructor), name(name)
+    SuiteInfo::SuiteInfo(void* ptr, ctor constructor, dtor destructor,
+        _ostest_internal::size_t size, _ostest_internal::size_t align, const char* name)
+        : ptr(ptr), constructor(constructor), destructor(destructor),
+          size(size), align(align), name(name)
+    {
+        registerSuite();
+    }
+
+    void SuiteInfo::registerSuite() noexcept
     {
         if (firstItem == nullptr) firstItem = this;
         else if (finalItem != nullptr) finalItem->nextItem = this;
@@ -321,14 +1261,14 @@ namespace ostest
        Returns the new test's test info.
     */
     TestInfo TestInfo::registerNew(SuiteInfo& suite, const char* name,
-        UnitTestWrapper& wrapper, const char* file, int line)
+        UnitTestWrapper& wrapper, const char* file, int line, bool benchmark)
     {
-        return TestInfo(suite, name, wrapper, file, line);
+        return TestInfo(suite, name, wrapper, file, line, benchmark);
     }
 
     TestInfo::TestInfo(SuiteInfo& suite, const char* name,
-        UnitTestWrapper& wrapper, const char* file, int line)
-        : wrapper(wrapper), line(line), suite(suite), name(name), file(file)
+        UnitTestWrapper& wrapper, const char* file, int line, bool benchmark)
+        : wrapper(wrapper), benchmark(benchmark), line(line), suite(suite), name(name), file(file)
     {
         // Register test with suite
         suite._tests.addItem(this);
@@ -336,98 +1276,286 @@ namespace ostest
 
     TestResult TestRunner::run()
     {
+#if OSTEST_NO_ALLOC
+        _ostest_internal::assertionPool.beginRun();
+#endif
         // Get the test instance
-        UnitTest& test = info.wrapper.newInstance(suite);
-
+        UnitTest& test = storage != nullptr ?
+            info.wrapper.newInstance(suite, storage) : info.wrapper.newInstance(suite);
+        test.result.summary.retention = retention;
+        test.result.summary.passLimit = lastPasses;
+
+#if OSTEST_STD_THREADS
+        _ostest_internal::_Watch watch(info, *this);
+        test.result.beginThreads();
+#endif
         // Perform testing
+        TestDuration start = readTimingClocks();
         suite.setUp();
+        TestDuration setUpEnd = readTimingClocks();
+#if OSTEST_TRACK_ALLOCATIONS
+        _ostest_internal::_AllocationTracker allocations{};
+#endif
+#if OSTEST_PERF_COUNTERS
+        _ostest_internal::_PerfMeasurement perf{};
+#endif
 
 #if OSTEST_STD_EXCEPTIONS
+        // Records an unhandled exception in the test's arena. Only the exception
+        // message is copied here, the full message is formatted when requested.
+        auto unhandled = [&test](const char* what, const char* typeName)
+        {
+            auto length = NoExceptionAssertion::messageLength(what);
+            void* where = test.allocateTemporary(NoExceptionAssertion::allocationSize(length, typeName),
+                alignof(NoExceptionAssertion));
+
+            (new (where) NoExceptionAssertion(what, length, typeName, test.getInfo()))->evaluate(test, false);
+        };
+
         try {
             test.testBody();
         }
         catch (const std::exception& e) {
-            (new NoExceptionAssertion(e, test.getInfo()))->evaluate(test, false);
+            unhandled(e.what(), exceptionTypeName(e));
         }
         // Please do not use 'new' when throwing exceptions!
         // This will NOT free the exception. This is to avoid aborting later.
         catch (const std::exception* e) {
-            (new NoExceptionAssertion(*e, test.getInfo()))->evaluate(test, false);
+            unhandled(e->what(), exceptionTypeName(*e));
         }
         catch (const std::string& str) {
-            (new NoExceptionAssertion(std::runtime_error(str.c_str()),
-                test.getInfo()))->evaluate(test, false);
+            unhandled(str.c_str(), nullptr);
         }
         catch (const char* msg) {
-            (new NoExceptionAssertion(std::runtime_error(msg), test.getInfo()))->evaluate(test, false);
+            unhandled(msg, nullptr);
         }
         catch (...) {
-            (new NoExceptionAssertion(std::exception(), test.getInfo()))->evaluate(test, false);
+            unhandled("", currentExceptionTypeName());
         }
 #else
         test.testBody();
 #endif
+#if OSTEST_PERF_COUNTERS
+        perf.end();
+#endif
+#if OSTEST_TRACK_ALLOCATIONS
+        allocations.end();
+#endif
+        TestDuration testBodyEnd = readTimingClocks();
         suite.tearDown();
+        TestDuration tearDownEnd = readTimingClocks();
+#if OSTEST_STD_THREADS
+        watch.end();
+        test.result.endThreads();
+#endif
+#if OSTEST_PERF_COUNTERS
+        test.result.setPerfCounters(perf.getCounters());
+#endif
+#if OSTEST_TRACK_ALLOCATIONS
+        test.result.setAllocationStats(allocations.getStats());
+        _ostest_internal::_checkAllocationBudget(test, allocations.getStats());
+#endif
 
         // Clean up
         TestResult result = test.result;
-        info.wrapper.deleteInstance();
+        result.setTimings(TestTimings{elapsed(start, setUpEnd),
+            elapsed(setUpEnd, testBodyEnd), elapsed(testBodyEnd, tearDownEnd)});
+        if (storage != nullptr) test.~UnitTest();
+        else info.wrapper.deleteInstance();
+
+#if OSTEST_NO_ALLOC
+        _ostest_internal::assertionPool.endRun();
+#endif
 
         // Notify test complete
-        ::ostest::handleTestComplete(info, result);
+        notifyComplete(info, result);
         return result;
     }
 
+    void TestRunner::notifyComplete(const TestInfo& info, const TestResult& result)
+    {
+#if OSTEST_STD_THREADS
+        if (auto reporter = AsyncReporter::getActive()) return reporter->push(info, result);
+#endif
+        ::ostest::handleTestComplete(info, result);
+    }
+
+#if OSTEST_SECTION_REGISTRATION
+}
+
+// Bounds of the test section, defined by the linker when it is non-empty
+extern "C" __attribute__((weak)) const ::ostest::TestInfo* const __start_ostest_tests[];
+extern "C" __attribute__((weak)) const ::ostest::TestInfo* const __stop_ostest_tests[];
+
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+    // Whether the test at 'a' in the section was defined before that at 'b', both in the same file
+    static bool _definedBefore(const TestInfo* const* a, const TestInfo* const* b)
+    {
+        return (*a)->line < (*b)->line || ((*a)->line == (*b)->line && a < b);
+    }
+}
+
+namespace ostest
+{
     SuiteIterator getSuites() noexcept
     {
+        // Link each test to its suite on first use, in definition order, and
+        // once only should several threads call at once
+        static const bool linked = []()
+        {
+            using _ostest_internal::_definedBefore;
+
+            auto test = __start_ostest_tests;
+            while (test != nullptr && test != __stop_ostest_tests)
+            {
+                // Files are contiguous in the section, but compilers may emit their tests
+                // in any order. The section cannot be reordered, so each file's tests are
+                // selected in order of line.
+                auto end = test + 1;
+                while (end != __stop_ostest_tests && _ostest_internal::_streq((*end)->file, (*test)->file)) end++;
+
+                const TestInfo* const* previous = nullptr;
+                for (long count = end - test; count != 0; count--)
+                {
+                    const TestInfo* const* next = nullptr;
+                    for (auto other = test; other != end; other++)
+                    {
+                        if (previous != nullptr && !_definedBefore(previous, other)) continue;
+                        if (next == nullptr || _definedBefore(other, next)) next = other;
+                    }
+                    previous = next;
+
+                    auto& info = const_cast<TestInfo&>(**next);
+                    auto& suite = const_cast<SuiteInfo&>(info.suite);
+                    if (suite.name == nullptr) {
+                        suite.name = info.suiteName;
+                        suite.registerSuite();
+                    }
+                    suite._tests.addItem(&info);
+                }
+                test = end;
+            }
+            return true;
+        }();
+        (void)linked;
         return SuiteIterator{SuiteInfo::firstItem};
     }
+#else
+    SuiteIterator getSuites() noexcept
+    {
+        return SuiteIterator{SuiteInfo::firstItem};
+    }
+#endif
+}
+
+namespace _ostest_internal
+{
+    using namespace ::ostest;
+
+#if !OSTEST_NO_ALLOC
+    const TestInfo** _getAllTests(size_t& count)
+    {
+        count = 0;
+        for (auto& suite : getSuites()) {
+            for (auto& test : suite.tests()) { (void)test; count++; }
+        }
+
+        auto tests = new const TestInfo*[count > 0 ? count : 1];
+        size_t t = 0;
+        for (auto& suite : getSuites()) {
+            for (auto& test : suite.tests()) tests[t++] = &test;
+        }
+        return tests;
+    }
+#endif
 
+    void _runTests(const TestInfo* const* tests, size_t count)
+    {
+        for (size_t i = 0; i < count;)
+        {
+            auto& suite = const_cast<SuiteInfo&>(tests[i]->suite);
+            auto instance = suite.getSingletonSmartPtr();
 
+            for (; i < count && &tests[i]->suite == &suite; i++) {
+                TestRunner(*instance, *tests[i]).run();
+            }
+        }
+    }
+}
+
+namespace ostest
+{
 #if OSTEST_STD_EXCEPTIONS
 
-    static const char noexceptionMsg[] = "An unhandled exception occurred: ";
+    static const char noexceptionMsg[] = "An unhandled exception occurred";
 
-    NoExceptionAssertion::NoExceptionAssertion(const std::exception& exception,
-        const TestInfo& test, bool temp) : Assertion("<unhandled exception>",
-            test.file, test.line, temp)
+    unsigned long NoExceptionAssertion::messageLength(const char* what)
     {
-        auto what = exception.what();
-
-        // Get exception message string length (up to 816)
         unsigned long length = 0;
-        for (; length <= 816; length++) {
+        for (; length < 816; length++) {
             if (what[length] == '\0') break;
         }
+        return length;
+    }
 
-        unsigned long msgIndex = 0;
-        auto msg = new char[sizeof(noexceptionMsg) + length];
+    // Reserves space for ": <type>: " once demangled, which may be up to
+    // twice the length of the implementation's name
+    unsigned long NoExceptionAssertion::headerSize(const char* typeName)
+    {
+        unsigned long size = sizeof(noexceptionMsg) - 1 + 2;
+        if (typeName != nullptr) size += 2 * _ostest_internal::_length(typeName) + 8;
+        return size;
+    }
 
-        // Copy message prefix
-        for (; msgIndex < sizeof(noexceptionMsg) - 1; msgIndex++) {
-            msg[msgIndex] = noexceptionMsg[msgIndex];
-        }
-        // Copy exception message
-        for (unsigned long i = 0; i < length + 1; i++, msgIndex++) {
-            msg[msgIndex] = what[i];
-        }
-        this->exceptionMsg = msg;
+    unsigned long NoExceptionAssertion::allocationSize(unsigned long whatLength, const char* typeName) {
+        return sizeof(NoExceptionAssertion) + headerSize(typeName) + whatLength + 1;
     }
 
-    NoExceptionAssertion::~NoExceptionAssertion() {
-        if (this->exceptionMsg != nullptr) delete[] this->exceptionMsg;
+    NoExceptionAssertion::NoExceptionAssertion(const char* what, unsigned long whatLength,
+        const char* typeName, const TestInfo& test) : CustomAssertion(&message, "<unhandled exception>",
+            _ostest_internal::_arenaalloc_tag{}, test.file, test.line), typeName(typeName),
+            whatOffset(headerSize(typeName)), whatLength(whatLength)
+    {
+        // The exception may not outlive the test, so copy its message now
+        char* msg = buffer() + whatOffset;
+        for (unsigned long i = 0; i < whatLength; i++) msg[i] = what[i];
+        msg[whatLength] = '\0';
     }
 
-    NoExceptionAssertion::NoExceptionAssertion(NoExceptionAssertion&& other)
-        : Assertion(other.expression, other.file, other.line, other.temporary)
+    const char* NoExceptionAssertion::message(const CustomAssertion& assertion)
     {
-        this->exceptionMsg = other.exceptionMsg;
-        other.exceptionMsg = nullptr;
+        auto& self = static_cast<const NoExceptionAssertion&>(assertion);
+        return self.format();
     }
 
-    const char* NoExceptionAssertion::getMessage() const
+    const char* NoExceptionAssertion::format() const
     {
-        return this->exceptionMsg;
+        char* msg = buffer();
+        if (formatted) return msg;
+
+        // Format "<prefix>: <type>: <what>", moving the message down to follow
+        // the header. The header never passes the start of the message.
+        _ostest_internal::_MessageWriter writer{msg, msg + whatOffset - 2};
+        writer.put(noexceptionMsg);
+        if (typeName != nullptr)
+        {
+            writer.put(": ");
+            _ostest_internal::_putTypeName(writer, typeName);
+        }
+        if (whatLength != 0)
+        {
+            *writer.ptr++ = ':';
+            *writer.ptr++ = ' ';
+            const char* what = msg + whatOffset;
+            for (unsigned long i = 0; i < whatLength; i++) *writer.ptr++ = what[i];
+        }
+        *writer.ptr = '\0';
+
+        formatted = true;
+        return msg;
     }
 
 #endif
@@ -13,6 +13,19 @@
 
 #include "ostest-impl.hpp"
 #include "ostest-assert.hpp"
+#include "ostest-bench.hpp"
+#include "ostest-parallel.hpp"
+#include "ostest-isolate.hpp"
+#include "ostest-filter.hpp"
+#include "ostest-report.hpp"
+#include "ostest-log.hpp"
+#include "ostest-async.hpp"
+#include "ostest-timeout.hpp"
+#include "ostest-history.hpp"
+#include "ostest-shard.hpp"
+#include "ostest-rerun.hpp"
+#include "ostest-alloc.hpp"
+#include "ostest-perf.hpp"
 
 namespace ostest
 {
@@ -26,6 +39,32 @@ namespace ostest
     */
     extern const bool ostest_std_exceptions;
 
+    /* Flag switching whether ostest supports running tests on multiple
+    threads. Set when ostest compiled with 'OSTEST_STD_THREADS'.
+    */
+    extern const bool ostest_std_threads;
+
+    /* Flag switching whether ostest supports POSIX process isolation.
+    Set when ostest compiled with 'OSTEST_POSIX'.
+    */
+    extern const bool ostest_posix;
+
+    /* Flag switching whether tests are registered via a linker section
+    rather than static constructors. Set when ostest compiled with
+    'OSTEST_SECTION_REGISTRATION'.
+    */
+    extern const bool ostest_section_registration;
+
+    /* Flag switching whether ostest counts the heap allocations made by each
+    test. Set when ostest compiled with 'OSTEST_TRACK_ALLOCATIONS'.
+    */
+    extern const bool ostest_track_allocations;
+
+    /* Flag switching whether ostest reads performance counters around each
+    test. Set when ostest compiled with 'OSTEST_PERF_COUNTERS'.
+    */
+    extern const bool ostest_perf_counters;
+
     /* User-defined test-complete handler. Run once a test has completed. */
     void handleTestComplete(const ostest::TestInfo&,
         const ostest::TestResult&);
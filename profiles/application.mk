@@ -1 +1 @@
-export PROFILE_CFLAGS = -DOSTEST_STD_EXCEPTIONS -fexceptions -frtti
+export PROFILE_CFLAGS = -DOSTEST_STD_EXCEPTIONS -DOSTEST_STD_THREADS -DOSTEST_POSIX -fexceptions -frtti -pthread
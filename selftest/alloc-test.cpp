@@ -0,0 +1,106 @@
+/* alloc-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <cstring>
+
+using namespace ostest;
+
+#if OSTEST_TRACK_ALLOCATIONS
+namespace selftest
+{
+    // Keeps allocations from being optimised away
+    static void* volatile allocationSink[3];
+
+    // Allocated before the test which frees it
+    static char* earlierAllocation = nullptr;
+
+    TEST_SUITE(_AllocSuite)
+
+    TEST_EX(::selftest, _AllocSuite, _Counted)
+    {
+        allocationSink[0] = new char[100];
+        allocationSink[1] = new char[200];
+        delete[] static_cast<char*>(allocationSink[0]);
+        allocationSink[2] = new char[300];
+        delete[] static_cast<char*>(allocationSink[1]);
+        delete[] static_cast<char*>(allocationSink[2]);
+    }
+    TEST_EX(::selftest, _AllocSuite, _FreesEarlier)
+    {
+        delete[] earlierAllocation;
+        allocationSink[0] = new char[100];
+        delete[] static_cast<char*>(allocationSink[0]);
+    }
+    TEST_EX(::selftest, _AllocSuite, _WithinBudget)
+    {
+        static Metadata<unsigned int> budget(*this, METADATA_NAME("max_allocs"), 0u);
+
+        // Assertions made by ostest are not counted
+        for (int i = 0; i < 1000; i++) {
+            EXPECT_ALL(i >= 0);
+        }
+    }
+    TEST_EX(::selftest, _AllocSuite, _OverBudget)
+    {
+        static Metadata<unsigned int> budget(*this, METADATA_NAME("max_allocs"), 1u);
+
+        allocationSink[0] = new int(1);
+        allocationSink[1] = new int(2);
+        delete static_cast<int*>(allocationSink[0]);
+        delete static_cast<int*>(allocationSink[1]);
+    }
+}
+
+TEST_SUITE(AllocSuite)
+
+TEST(AllocSuite, TrackingTest)
+{
+    unsigned int count = 0;
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_AllocSuite") != 0) continue;
+
+        auto suiteInstance = suite.getSingletonSmartPtr();
+        for (auto& test : suite.tests())
+        {
+            selftest::earlierAllocation = new char[1000];
+            auto result = TestRunner(*suiteInstance, test).run();
+            ASSERT_NEQ_ALL(result.getAllocationStats(), nullptr);
+            auto& stats = *result.getAllocationStats();
+
+            if (std::strcmp(test.name, "_Counted") == 0)
+            {
+                EXPECT_ALL(result.succeeded());
+                EXPECT_EQ_ALL(stats.allocations, 3u);
+                EXPECT_EQ_ALL(stats.deallocations, 3u);
+                EXPECT_EQ_ALL(stats.bytes, 600u);
+                EXPECT_EQ_ALL(stats.peakBytes, 500u);
+            }
+            else if (std::strcmp(test.name, "_FreesEarlier") == 0)
+            {
+                // Freeing the earlier allocation does not offset the test's own
+                EXPECT_EQ_ALL(stats.deallocations, 2u);
+                EXPECT_EQ_ALL(stats.bytes, 100u);
+                EXPECT_EQ_ALL(stats.peakBytes, 100u);
+            }
+            else if (std::strcmp(test.name, "_WithinBudget") == 0)
+            {
+                EXPECT_ALL(result.succeeded());
+                EXPECT_ZERO_ALL(stats.allocations);
+                EXPECT_EQ_ALL(countAssertions(result), 1000u);
+            }
+            else
+            {
+                EXPECT_EQ_ALL(stats.allocations, 2u);
+                EXPECT_EQ_ALL(result.getFailureCount(), 1u);
+                ASSERT_NEQ_ALL(result.getFirstFailure(), nullptr);
+                EXPECT_ZERO_ALL(std::strcmp(result.getFirstFailure()->getMessage(),
+                    "Made 2 allocations, exceeding the budget of 1."));
+            }
+            if (std::strcmp(test.name, "_FreesEarlier") != 0) delete[] selftest::earlierAllocation;
+            count++;
+        }
+        break;
+    }
+    EXPECT_EQ(count, 4u);
+}
+#endif
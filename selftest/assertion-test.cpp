@@ -1,16 +1,24 @@
 /* assertion-test.cpp - (c) 2018 James Renwick */
 #include "common.hpp"
+#include <cstddef>
+#if OSTEST_STD_THREADS
+#include <thread>
+#include <vector>
+#endif
 
 using namespace ostest;
 
 namespace selftest
 {
 #define TEST_EXPECT_ALL_FAIL \
-    static Metadata<TestExpect> _(*this, "expect", TestExpect::AllFail)
+    static Metadata<TestExpect> _(*this, METADATA_NAME("expect"), TestExpect::AllFail)
 
 
     TEST_SUITE(_AssertionSuite)
 
+    // Operands are only captured by failures, so passing comparisons cost no more than other assertions
+    static_assert(sizeof(_ostest_internal::_assert_eq) == sizeof(Assertion), "Comparisons hold operands");
+
     TEST_EX(::selftest, _AssertionSuite, _TestAssertPass) {
         ASSERT(1 == 1);
     }
@@ -24,7 +32,6 @@ namespace selftest
         ASSERT(1 != 1);
         EXPECT(true);
     }
-#if !OSTEST_NO_ALLOC
     TEST_EX(::selftest, _AssertionSuite, _TestAssertionCountPass1)
     {
         EXPECT_ONCE(true);
@@ -70,7 +77,6 @@ namespace selftest
         EXPECT_EQ_ALL(countAssertions(this->getResult()), 23);
         ASSERT_EQ_ALL(countAssertions(this->getResult()), 24);
     }
-#endif
     TEST_EX(::selftest, _AssertionSuite, _TestAssertionCountPass5)
     {
         EXPECT_ZERO(countAssertions(this->getResult()));
@@ -78,7 +84,6 @@ namespace selftest
         EXPECT_EQ(countAssertions(this->getResult()), 2);
         EXPECT_EQ(countAssertions(this->getResult()), 3);
     }
-#if !OSTEST_NO_ALLOC
     TEST_EX(::selftest, _AssertionSuite, _TestAssertAllPass) {
         for (int i = 0; i < 100; i++) {
             ASSERT_ALL(i < 100);
@@ -90,7 +95,6 @@ namespace selftest
             ASSERT_ALL(i < 0);
         }
     }
-#endif
     TEST_EX(::selftest, _AssertionSuite, _TestAssertZeroPass) {
         ASSERT_ZERO(0);
     }
@@ -165,7 +169,6 @@ namespace selftest
         TEST_EXPECT_ALL_FAIL;
         EXPECT(1 != 1);
     }
-#if !OSTEST_NO_ALLOC
     TEST_EX(::selftest, _AssertionSuite, _TestExpectAllPass) {
         for (int i = 0; i < 100; i++) {
             EXPECT_ALL(i < 100);
@@ -179,7 +182,6 @@ namespace selftest
         }
         EXPECT_NEQ_ONCE(countAssertions(this->getResult()), 10);
     }
-#endif
     TEST_EX(::selftest, _AssertionSuite, _TestExpectZeroPass) {
         EXPECT_ZERO(0);
     }
@@ -208,6 +210,24 @@ namespace selftest
         TEST_EXPECT_ALL_FAIL;
         EXPECT_NEQ(1, 1);
     }
+    TEST_EX(::selftest, _AssertionSuite, _TestExpectNullPass)
+    {
+        int value = 0;
+        int* null = nullptr;
+        ASSERT_EQ(null, 0);
+        EXPECT_EQ(null, NULL);
+        EXPECT_EQ(0, null);
+        EXPECT_NEQ(&value, 0);
+        EXPECT_NEQ_ONCE(&value, NULL);
+        EXPECT_EQ(value, 0);
+    }
+    TEST_EX(::selftest, _AssertionSuite, _TestExpectNullFail)
+    {
+        TEST_EXPECT_ALL_FAIL;
+        int value = 0;
+        EXPECT_EQ(&value, 0);
+        EXPECT_NEQ(NULL, static_cast<int*>(nullptr));
+    }
     TEST_EX(::selftest, _AssertionSuite, _TestExpectLtPass) {
         EXPECT_LT(1, 2);
     }
@@ -255,7 +275,6 @@ namespace selftest
         EXPECT_EQ(iteration, 10);
         EXPECT_EQ(countAssertions(this->getResult()), 2);
     }
-#if !OSTEST_NO_ALLOC
     TEST_EX(::selftest, _AssertionSuite, _TestExpectAllOrBreakPass)
     {
         int iteration = 0;
@@ -265,7 +284,6 @@ namespace selftest
         EXPECT_EQ(iteration, 10);
         EXPECT_EQ(countAssertions(this->getResult()), 11);
     }
-#endif
     TEST_EX(::selftest, _AssertionSuite, _TestExpectOnceOrBreakFail)
     {
         TEST_EXPECT_ALL_FAIL;
@@ -276,7 +294,6 @@ namespace selftest
         EXPECT_NEQ(iteration, 5);
         EXPECT_NEQ(countAssertions(this->getResult()), 2);
     }
-#if !OSTEST_NO_ALLOC
     TEST_EX(::selftest, _AssertionSuite, _TestExpectAllOrBreakFail)
     {
         TEST_EXPECT_ALL_FAIL;
@@ -287,6 +304,101 @@ namespace selftest
         EXPECT_NEQ(iteration, 0);
         EXPECT_NEQ(countAssertions(this->getResult()), 2);
     }
+
+
+    TEST_SUITE(_EachSuite)
+
+    TEST_EX(::selftest, _EachSuite, _Pass)
+    {
+        for (int i = 0; i < 100000; i++) {
+            EXPECT_EACH(i >= 0);
+        }
+    }
+    TEST_EX(::selftest, _EachSuite, _Fail)
+    {
+        for (int i = 0; i < 1000; i++) {
+            EXPECT_EACH(i % 100 != 5);
+        }
+    }
+    TEST_EX(::selftest, _EachSuite, _AssertFail)
+    {
+        for (int i = 0; i < 1000; i++) {
+            ASSERT_EACH(i != 10);
+        }
+    }
+
+
+    TEST_SUITE(_MessageSuite)
+
+    enum class _Colour { red = 1, green = 2 };
+
+    struct _Uncapturable
+    {
+        int value;
+        bool operator ==(const _Uncapturable& other) const { return value == other.value; }
+    };
+
+    TEST_EX(::selftest, _MessageSuite, _Signed) {
+        EXPECT_LT(3, -7);
+    }
+    TEST_EX(::selftest, _MessageSuite, _Unsigned) {
+        EXPECT_EQ(5u, 18446744073709551615ull);
+    }
+    TEST_EX(::selftest, _MessageSuite, _Boolean) {
+        EXPECT_EQ(true, false);
+    }
+    TEST_EX(::selftest, _MessageSuite, _Character) {
+        EXPECT_GTEQ('a', 'b');
+    }
+    TEST_EX(::selftest, _MessageSuite, _Floating) {
+        EXPECT_GT(0.5, 2.25);
+    }
+    TEST_EX(::selftest, _MessageSuite, _Zero) {
+        EXPECT_ZERO(-4);
+    }
+    TEST_EX(::selftest, _MessageSuite, _Null)
+    {
+        int value = 0;
+        EXPECT_EQ(&value, nullptr);
+    }
+    TEST_EX(::selftest, _MessageSuite, _Enum) {
+        EXPECT_EQ(_Colour::red, _Colour::green);
+    }
+    TEST_EX(::selftest, _MessageSuite, _Other) {
+        EXPECT_EQ(_Uncapturable{1}, _Uncapturable{2});
+    }
+
+    static const char* _customMessage(const CustomAssertion& assertion) {
+        return assertion.passed() ? "" : "A custom assertion failed.";
+    }
+
+    TEST_EX(::selftest, _MessageSuite, _Custom)
+    {
+        static CustomAssertion assertion(&_customMessage, "custom", __FILE__, __LINE__);
+        assertion.evaluate(*this, false);
+    }
+
+#if OSTEST_STD_THREADS
+    TEST_SUITE(_ThreadSuite)
+
+    TEST_EX(::selftest, _ThreadSuite, _Workers)
+    {
+        EXPECT(true);
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; t++)
+        {
+            workers.emplace_back([this, t]() {
+                for (int i = 0; i < 100; i++)
+                {
+                    EXPECT(i < 100);
+                    EXPECT_EQ_ALL(i, i);
+                    if (t == 2 && i == 50) EXPECT_EQ(t, 3);
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+    }
 #endif
 }
 
@@ -313,3 +425,121 @@ TEST(AssertionSuite, AssertionsTest)
         break;
     }
 }
+
+TEST(AssertionSuite, EachTest)
+{
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_EachSuite") != 0) continue;
+
+        auto suiteInstance = suite.getSingletonSmartPtr();
+        for (auto& test : suite.tests())
+        {
+            // Each run restarts the counts
+            for (int run = 0; run < 2; run++)
+            {
+                auto result = TestRunner(*suiteInstance, test).run();
+                ASSERT_EQ_ALL(countAssertions(result), 1);
+
+                auto& assertion = *result.getAssertions().begin();
+                ASSERT_ALL(assertion.getKind() == AssertionKind::Each);
+                auto& each = static_cast<const EachAssertion&>(assertion);
+
+                if (std::strcmp(test.name, "_Pass") == 0)
+                {
+                    EXPECT_ALL(result.succeeded());
+                    EXPECT_EQ_ALL(each.getEvaluations(), 100000u);
+                    EXPECT_EQ_ALL(each.getPasses(), 100000u);
+                    EXPECT_ZERO_ALL(std::strcmp(each.getMessage(), ""));
+                }
+                else if (std::strcmp(test.name, "_Fail") == 0)
+                {
+                    EXPECT_ALL(!result.succeeded());
+                    EXPECT_EQ_ALL(each.getEvaluations(), 1000u);
+                    EXPECT_EQ_ALL(each.getFailures(), 10u);
+                    EXPECT_EQ_ALL(each.getFirstFailure(), 5u);
+                    EXPECT_EQ_ALL(each.getFinalFailure(), 905u);
+                    EXPECT_ZERO_ALL(std::strcmp(each.getMessage(),
+                        "Failed 10 of 1000 evaluations, first at index 5, final at index 905."));
+                }
+                else
+                {
+                    EXPECT_ALL(!result.succeeded());
+                    EXPECT_EQ_ALL(each.getEvaluations(), 11u);
+                    EXPECT_ZERO_ALL(std::strcmp(each.getMessage(), "Failed 1 of 11 evaluations, at index 10."));
+                }
+            }
+        }
+        break;
+    }
+}
+
+TEST(AssertionSuite, MessageTest)
+{
+    // Pointers are formatted as hex, so only the start of the message is compared
+    static const struct { const char* test; const char* message; bool prefix; } expected[] = {
+        {"_Signed",    "Expected 3 < -7.", false},
+        {"_Unsigned",  "Expected 5 == 18446744073709551615.", false},
+        {"_Boolean",   "Expected true == false.", false},
+        {"_Character", "Expected 'a' >= 'b'.", false},
+        {"_Floating",  "Expected 0.5 > 2.25.", false},
+        {"_Zero",      "Expected -4 == 0.", false},
+        {"_Null",      "Expected 0x", true},
+        {"_Enum",      "Expected 1 == 2.", false},
+        {"_Other",     "Expected equal values.", false},
+        {"_Custom",    "A custom assertion failed.", false},
+    };
+
+    unsigned int count = 0;
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_MessageSuite") != 0) continue;
+
+        auto suiteInstance = suite.getSingletonSmartPtr();
+        for (auto& test : suite.tests())
+        {
+            auto result = TestRunner(*suiteInstance, test).run();
+            ASSERT_NEQ_ALL(result.getFirstFailure(), nullptr);
+            const char* message = result.getFirstFailure()->getMessage();
+
+            for (auto& entry : expected)
+            {
+                if (std::strcmp(entry.test, test.name) != 0) continue;
+                size_t length = entry.prefix ? std::strlen(entry.message) : std::strlen(message) + 1;
+                EXPECT_ZERO_ALL(std::strncmp(message, entry.message, length));
+                count++;
+            }
+            // The message is formatted once, then reused
+            EXPECT_EQ_ALL(result.getFirstFailure()->getMessage(), message);
+            EXPECT_ALL((result.getFirstFailure()->getKind() == AssertionKind::Custom) ==
+                (std::strcmp(test.name, "_Custom") == 0));
+        }
+        break;
+    }
+    EXPECT_EQ(count, 10u);
+}
+
+#if OSTEST_STD_THREADS
+TEST(AssertionSuite, ThreadTest)
+{
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_ThreadSuite") != 0) continue;
+
+        auto suiteInstance = suite.getSingletonSmartPtr();
+        for (auto& test : suite.tests())
+        {
+            auto result = TestRunner(*suiteInstance, test).run();
+
+            // Each assertion made on a worker is recorded separately
+            EXPECT_EQ_ALL(countAssertions(result), 802u);
+            EXPECT_EQ_ALL(result.getPassCount(), 801u);
+            EXPECT_EQ_ALL(result.getFailureCount(), 1u);
+            ASSERT_NEQ_ALL(result.getFirstFailure(), nullptr);
+            EXPECT_ZERO_ALL(std::strcmp(result.getFirstFailure()->getMessage(), "Expected 2 == 3."));
+            EXPECT_ZERO_ALL(std::strcmp((*result.getAssertions().begin()).expression, "true"));
+        }
+        break;
+    }
+}
+#endif
@@ -0,0 +1,127 @@
+/* async-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace ostest;
+
+#if OSTEST_STD_THREADS
+namespace selftest
+{
+    TEST_SUITE(_AsyncSuite)
+
+#define ASYNC_TEST(name) \
+    TEST_EX(::selftest, _AsyncSuite, name) \
+    { \
+        for (int i = 0; i < 50; i++) EXPECT_ALL(i < 50); \
+    }
+
+    ASYNC_TEST(_Test01) ASYNC_TEST(_Test02) ASYNC_TEST(_Test03) ASYNC_TEST(_Test04)
+    ASYNC_TEST(_Test05) ASYNC_TEST(_Test06) ASYNC_TEST(_Test07) ASYNC_TEST(_Test08)
+
+#undef ASYNC_TEST
+
+    TEST_EX(::selftest, _AsyncSuite, _TestFail) {
+        EXPECT_EQ_ALL(1, 2);
+    }
+
+    // Tests handled by the reporter thread
+    struct _AsyncHandled
+    {
+        const TestInfo* info;
+        std::thread::id thread;
+        unsigned int passCount;
+        unsigned int failCount;
+        int failureLine;
+    };
+    static std::vector<_AsyncHandled> asyncHandled{};
+
+    static void _handleAsync(const TestInfo& info, const TestResult& result)
+    {
+        // Handle slowly, so that runners must wait for space
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+        auto failure = result.getFirstFailure();
+        asyncHandled.push_back(_AsyncHandled{&info, std::this_thread::get_id(),
+            result.getPassCount(), result.getFailureCount(), failure ? failure->line : 0});
+    }
+
+    static std::vector<const TestInfo*> _getAsyncTests()
+    {
+        std::vector<const TestInfo*> tests{};
+        for (auto& suite : getSuites())
+        {
+            if (std::strcmp(suite.name, "_AsyncSuite") != 0) continue;
+            for (auto& test : suite.tests()) tests.push_back(&test);
+        }
+        return tests;
+    }
+}
+
+
+TEST_SUITE(AsyncSuite)
+
+TEST(AsyncSuite, AsyncReportTest)
+{
+    auto tests = selftest::_getAsyncTests();
+    ASSERT_EQ(tests.size(), 9u);
+    selftest::asyncHandled.clear();
+
+    {
+        AsyncReporter reporter(2, selftest::_handleAsync);
+        EXPECT_EQ(AsyncReporter::getActive(), &reporter);
+
+        for (auto& suiteInfo : getSuites())
+        {
+            if (std::strcmp(suiteInfo.name, "_AsyncSuite") != 0) continue;
+
+            auto suite = suiteInfo.getSingletonSmartPtr();
+            for (auto& test : suiteInfo.tests()) TestRunner(*suite, test).run();
+        }
+        reporter.flush();
+        EXPECT_EQ(selftest::asyncHandled.size(), tests.size());
+    }
+    EXPECT_EQ(AsyncReporter::getActive(), nullptr);
+
+    // Tests are handled on the reporter thread, in order, with intact results
+    ASSERT_EQ(selftest::asyncHandled.size(), tests.size());
+    for (size_t i = 0; i < tests.size(); i++)
+    {
+        auto& handled = selftest::asyncHandled[i];
+        EXPECT_EQ_ALL(handled.info, tests[i]);
+        EXPECT_NEQ_ALL(handled.thread, std::this_thread::get_id());
+
+        if (std::strcmp(handled.info->name, "_TestFail") == 0) {
+            EXPECT_EQ_ALL(handled.failCount, 1u);
+            EXPECT_EQ_ALL(handled.failureLine, handled.info->line + 1);
+        }
+        else {
+            EXPECT_EQ_ALL(handled.passCount, 50u);
+            EXPECT_EQ_ALL(handled.failCount, 0u);
+        }
+    }
+}
+
+TEST(AsyncSuite, AsyncParallelTest)
+{
+    auto tests = selftest::_getAsyncTests();
+    selftest::asyncHandled.clear();
+
+    {
+        // Tests queued by multiple workers are all handled before the reporter is destroyed
+        AsyncReporter reporter(4, selftest::_handleAsync);
+        ParallelRunner(4).run(tests.data(), tests.size());
+    }
+
+    ASSERT_EQ(selftest::asyncHandled.size(), tests.size());
+    unsigned int failures = 0;
+    for (auto& handled : selftest::asyncHandled)
+    {
+        failures += handled.failCount;
+        EXPECT_EQ_ALL(handled.passCount + handled.failCount, handled.failCount ? 1u : 50u);
+    }
+    EXPECT_EQ(failures, 1u);
+}
+#endif
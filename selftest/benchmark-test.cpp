@@ -0,0 +1,124 @@
+/* benchmark-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <cstring>
+
+using namespace ostest;
+
+namespace selftest
+{
+    // Clock advanced only by the benchmark body, for deterministic timings
+    static unsigned long long benchmarkTicks = 0;
+    static unsigned long long benchmarkClock() { return benchmarkTicks; }
+
+    class _BenchmarkSuite : public TestSuite
+    {
+    public:
+        unsigned int setUpCount = 0;
+        unsigned int tearDownCount = 0;
+        unsigned long long bodyCount = 0;
+
+        void setUp() override { setUpCount++; }
+        void tearDown() override { tearDownCount++; }
+    };
+
+    BENCHMARK_EX(::selftest, _BenchmarkSuite, _ConstantBenchmark)
+    {
+        suite.bodyCount++;
+        benchmarkTicks += 100;
+    }
+
+    BENCHMARK_EX(::selftest, _BenchmarkSuite, _FailingBenchmark)
+    {
+        suite.bodyCount++;
+        ASSERT(false);
+    }
+
+    TEST_EX(::selftest, _BenchmarkSuite, _NotABenchmark)
+    {
+        EXPECT(true);
+    }
+}
+
+
+TEST_SUITE(BenchmarkSuite)
+
+TEST(BenchmarkSuite, BenchmarkTest)
+{
+    BenchmarkOptions options{};
+    options.minSampleTime = 1000;
+    options.warmUpTime = 0;
+    options.sampleCount = 5;
+
+    const BenchmarkOptions previous = getBenchmarkOptions();
+    setBenchmarkOptions(options);
+
+    for (auto& suiteInfo : getSuites())
+    {
+        if (std::strcmp(suiteInfo.name, "_BenchmarkSuite") != 0) continue;
+
+        auto suitePtr = suiteInfo.getSingletonSmartPtr();
+        auto& suite = static_cast<selftest::_BenchmarkSuite&>(*suitePtr);
+
+        for (auto& test : suiteInfo.tests())
+        {
+            suite.setUpCount = suite.tearDownCount = 0;
+            suite.bodyCount = 0;
+
+            setTimingClocks(selftest::benchmarkClock, nullptr);
+            auto result = TestRunner(*suitePtr, test).run();
+            resetTimingClocks();
+
+            // Fixtures are shared with tests, and run once per benchmark
+            EXPECT_EQ(suite.setUpCount, 1u);
+            EXPECT_EQ(suite.tearDownCount, 1u);
+
+            if (std::strcmp(test.name, "_ConstantBenchmark") == 0)
+            {
+                EXPECT(test.isBenchmark());
+                EXPECT(result.succeeded());
+                ASSERT_NEQ(result.getBenchmarkStats(), nullptr);
+
+                // Calibration takes 1 then 10 iterations, then 5 samples of 10
+                auto& stats = *result.getBenchmarkStats();
+                EXPECT_EQ(stats.iterations, 10u);
+                EXPECT_EQ(stats.samples, 5u);
+                EXPECT_EQ(suite.bodyCount, 1u + 10u + 5u * 10u);
+                EXPECT_EQ(stats.mean, 100.0);
+                EXPECT_EQ(stats.median, 100.0);
+                EXPECT_EQ(stats.p99, 100.0);
+                EXPECT_EQ(stats.stddev, 0.0);
+                EXPECT_EQ(stats.opsPerSecond, 1e7);
+            }
+            else if (std::strcmp(test.name, "_FailingBenchmark") == 0)
+            {
+                // Benchmarks which fail are not measured further
+                EXPECT(test.isBenchmark());
+                EXPECT(!result.succeeded());
+                EXPECT_EQ(result.getBenchmarkStats(), nullptr);
+                EXPECT_EQ(suite.bodyCount, 1u);
+            }
+            else
+            {
+                EXPECT(!test.isBenchmark());
+                EXPECT(result.succeeded());
+                EXPECT_EQ(result.getBenchmarkStats(), nullptr);
+            }
+        }
+
+        // Without a clock, benchmarks fail
+        for (auto& test : suiteInfo.tests())
+        {
+            if (!test.isBenchmark()) continue;
+
+            setTimingClocks(nullptr, nullptr);
+            auto result = TestRunner(*suitePtr, test).run();
+            resetTimingClocks();
+
+            EXPECT(!result.succeeded());
+            EXPECT_EQ(result.getBenchmarkStats(), nullptr);
+            break;
+        }
+        break;
+    }
+    setBenchmarkOptions(previous);
+}
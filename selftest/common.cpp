@@ -19,13 +19,13 @@ size_t countAssertions(const TestResult& result)
 
 TestExpect getTestFailRequirement(const TestInfo& test)
 {
-    auto* meta = test.getMetadata<TestExpect>("expect");
+    auto* meta = test.getMetadata<TestExpect>(METADATA_NAME("expect"));
     return meta ? meta->value : TestExpect::AllPass;
 }
 
 bool assertionShouldFail(const TestInfo& test, const Assertion& target)
 {
-    auto* fails = test.getMetadata<Assertion**>("fails");
+    auto* fails = test.getMetadata<Assertion**>(METADATA_NAME("fails"));
     if (!fails) return false;
 
     for (Assertion** stmt = fails->value; *stmt != nullptr; stmt++) {
@@ -90,6 +90,13 @@ void printTestResult(const TestInfo& test, bool succeeded, const TestResult& res
 }
 
 
+static bool isInternalTest(const TestInfo& test)
+{
+    return std::strlen(test.suite.name) > 0 && test.suite.name[0] == '_';
+}
+
+static unsigned int failedTests = 0;
+
 int main()
 {
     for (SuiteInfo& suiteInfo : ostest::getSuites())
@@ -98,15 +105,22 @@ int main()
         for (auto& test : suiteInfo.tests())
         {
             // Skip internal tests
-            if (std::strlen(test.suite.name) > 0 && test.suite.name[0] == '_') continue;
+            if (isInternalTest(test)) continue;
             // Run normal tests
             TestRunner(*suite, test).run();
         }
     }
-    return 0;
+    return failedTests == 0 ? 0 : 1;
 }
 
-void ostest::handleTestComplete(const TestInfo&, const TestResult&)
+void ostest::handleTestComplete(const TestInfo& test, const TestResult& result)
 {
+    // Internal tests are checked by the normal tests which run them
+    if (isInternalTest(test)) return;
 
+    if (!result.succeeded())
+    {
+        failedTests++;
+        printTestResult(test, false, result);
+    }
 }
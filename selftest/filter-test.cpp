@@ -0,0 +1,101 @@
+/* filter-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <cstring>
+
+using namespace ostest;
+
+#if !OSTEST_NO_ALLOC
+namespace selftest
+{
+    static unsigned int filterRunCount = 0;
+    static unsigned int unselectedSuiteCount = 0;
+
+    TEST_SUITE(_FilterSuiteA)
+    TEST_SUITE(_FilterSuiteB)
+
+    class _FilterSuiteC : public TestSuite
+    {
+    public:
+        _FilterSuiteC() { unselectedSuiteCount++; }
+    };
+
+    TEST_EX(::selftest, _FilterSuiteA, _Fast1) { filterRunCount++; }
+    TEST_EX(::selftest, _FilterSuiteA, _Slow1) { filterRunCount++; }
+    TEST_EX(::selftest, _FilterSuiteA, _Fast2) { filterRunCount++; }
+    TEST_EX(::selftest, _FilterSuiteB, _Fast1) { filterRunCount++; }
+    TEST_EX(::selftest, _FilterSuiteC, _Fast1) { filterRunCount++; }
+
+    // Checks that the filter selected exactly the given "Suite.Test" names, in order
+    static bool _selectedExactly(const TestFilter& filter, const char* const* names, size_t count)
+    {
+        if (filter.getCount() != count) return false;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const TestInfo& test = *filter.tests()[i];
+            size_t suiteLength = std::strlen(test.suite.name);
+            if (std::strncmp(names[i], test.suite.name, suiteLength) != 0 ||
+                names[i][suiteLength] != '.' ||
+                std::strcmp(names[i] + suiteLength + 1, test.name) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+
+TEST_SUITE(FilterSuite)
+
+TEST(FilterSuite, PatternTest)
+{
+    using selftest::_selectedExactly;
+
+    // Whole suite, less a negative pattern
+    {
+        const char* names[] = { "_FilterSuiteA._Fast1", "_FilterSuiteA._Fast2" };
+        EXPECT(_selectedExactly(TestFilter("_FilterSuiteA.*:-_FilterSuiteA._Slow*"), names, 2));
+    }
+    // Exact names are selected in registration order, without duplicates
+    {
+        const char* names[] = { "_FilterSuiteA._Fast1", "_FilterSuiteA._Slow1" };
+        EXPECT(_selectedExactly(TestFilter("_FilterSuiteA._Slow1:_FilterSuiteA._Fast1:_FilterSuiteA._Fast1"), names, 2));
+    }
+    // Wildcards within the suite name
+    {
+        const char* names[] = { "_FilterSuiteA._Fast1", "_FilterSuiteB._Fast1", "_FilterSuiteC._Fast1" };
+        EXPECT(_selectedExactly(TestFilter("_FilterSuite?._Fast1"), names, 3));
+        EXPECT(_selectedExactly(TestFilter("_Filter*1:-*A._*:*Suite*._Slow?"), names + 1, 2));
+    }
+    // Unknown names
+    EXPECT_EQ(TestFilter("_FilterSuiteD.*").getCount(), 0u);
+    EXPECT_EQ(TestFilter("_FilterSuiteA._Fast").getCount(), 0u);
+    EXPECT_EQ(TestFilter("_FilterSuiteA").getCount(), 0u);
+
+    // Negative patterns alone
+    TestFilter all("");
+    TestFilter external("-_*");
+    EXPECT(all.getCount() > external.getCount());
+    EXPECT(external.getCount() > 0u);
+    for (size_t i = 0; i < external.getCount(); i++) {
+        EXPECT_NEQ(external.tests()[i]->suite.name[0], '_');
+    }
+}
+
+TEST(FilterSuite, RunTest)
+{
+    selftest::filterRunCount = 0;
+    selftest::unselectedSuiteCount = 0;
+
+    TestFilter("_FilterSuiteA._Fast*:_FilterSuiteB.*").run();
+
+    EXPECT_EQ(selftest::filterRunCount, 3u);
+    // Suites without selected tests are not constructed
+    EXPECT_EQ(selftest::unselectedSuiteCount, 0u);
+
+    TestFilter("_FilterSuiteC.*").run();
+    EXPECT_EQ(selftest::filterRunCount, 4u);
+    EXPECT_EQ(selftest::unselectedSuiteCount, 1u);
+}
+#endif
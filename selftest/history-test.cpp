@@ -0,0 +1,162 @@
+/* history-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if OSTEST_POSIX
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+using namespace ostest;
+
+#if !OSTEST_NO_ALLOC
+namespace selftest
+{
+    TEST_SUITE(_HistorySuite)
+
+    TEST_EX(::selftest, _HistorySuite, _TestA) {
+        EXPECT(true);
+    }
+    TEST_EX(::selftest, _HistorySuite, _TestB) {
+        EXPECT(true);
+    }
+    TEST_EX(::selftest, _HistorySuite, _TestC) {
+        EXPECT(true);
+    }
+    TEST_EX(::selftest, _HistorySuite, _TestD) {
+        EXPECT(false);
+    }
+
+    static std::vector<const TestInfo*> _getHistoryTests()
+    {
+        std::vector<const TestInfo*> tests{};
+        for (auto& suite : getSuites())
+        {
+            if (std::strcmp(suite.name, "_HistorySuite") != 0) continue;
+            for (auto& test : suite.tests()) tests.push_back(&test);
+        }
+        return tests;
+    }
+
+    static TestResult _timedResult(unsigned long long time, bool passed)
+    {
+        TestResult result{};
+        result.setTimings(TestTimings{{0, 0}, {time, time}, {0, 0}});
+        if (!passed) (new Assertion("false", _ostest_internal::_heapalloc_tag{}, __FILE__, __LINE__, true))->evaluate(result, false);
+        return result;
+    }
+
+    // Records A: 10, C: 50, D: 50 (failed), leaving B unknown
+    static void _recordHistory(TestHistory& history, const std::vector<const TestInfo*>& tests)
+    {
+        history.record(*tests[0], _timedResult(10, true));
+        history.record(*tests[2], _timedResult(50, true));
+        history.record(*tests[3], _timedResult(50, false));
+    }
+}
+
+
+TEST_SUITE(HistorySuite)
+
+TEST(HistorySuite, HistoryScheduleTest)
+{
+    auto tests = selftest::_getHistoryTests();
+    ASSERT_EQ(tests.size(), 4u);
+
+    TestHistory history{};
+    selftest::_recordHistory(history, tests);
+    EXPECT_EQ(history.getCount(), 3u);
+    EXPECT_EQ(history.getPath(), nullptr);
+
+    unsigned long long duration = 0;
+    EXPECT(history.getDuration(*tests[2], duration));
+    EXPECT_EQ(duration, 50u);
+    EXPECT(!history.getDuration(*tests[1], duration));
+    EXPECT(history.hasFailed(*tests[3]));
+    EXPECT(!history.hasFailed(*tests[2]));
+    EXPECT(!history.hasFailed(*tests[1]));
+
+    // Unknown tests first, then longest-first, keeping the given order for ties
+    auto scheduled = tests;
+    history.schedule(scheduled.data(), scheduled.size());
+    EXPECT_EQ(scheduled[0], tests[1]);
+    EXPECT_EQ(scheduled[1], tests[2]);
+    EXPECT_EQ(scheduled[2], tests[3]);
+    EXPECT_EQ(scheduled[3], tests[0]);
+
+    scheduled = tests;
+    history.schedule(scheduled.data(), scheduled.size(), true);
+    EXPECT_EQ(scheduled[0], tests[3]);
+    EXPECT_EQ(scheduled[1], tests[1]);
+    EXPECT_EQ(scheduled[2], tests[2]);
+    EXPECT_EQ(scheduled[3], tests[0]);
+
+    // Recording again replaces the previous duration
+    history.record(*tests[0], selftest::_timedResult(70, true));
+    EXPECT_EQ(history.getCount(), 3u);
+    EXPECT(history.getDuration(*tests[0], duration));
+    EXPECT_EQ(duration, 70u);
+}
+
+#if OSTEST_POSIX
+TEST(HistorySuite, HistoryCacheTest)
+{
+    auto tests = selftest::_getHistoryTests();
+    char path[] = "/tmp/ostest-history-XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT(fd >= 0);
+    ::close(fd);
+
+    // An empty file is not a valid history
+    {
+        TestHistory history(path);
+        EXPECT_EQ(history.getCount(), 0u);
+        EXPECT_ZERO(std::strcmp(history.getPath(), path));
+
+        selftest::_recordHistory(history, tests);
+        EXPECT(history.save());
+    }
+    {
+        TestHistory history(path);
+        EXPECT_EQ(history.getCount(), 3u);
+
+        unsigned long long duration = 0;
+        EXPECT(history.getDuration(*tests[3], duration));
+        EXPECT_EQ(duration, 50u);
+        EXPECT(history.hasFailed(*tests[3]));
+        EXPECT(!history.getDuration(*tests[1], duration));
+    }
+
+    // Invalid files add nothing
+    std::FILE* file = std::fopen(path, "ab");
+    ASSERT(file != nullptr);
+    std::fputs("12 x _HistorySuite _TestB\n", file);
+    std::fclose(file);
+
+    TestHistory history{};
+    EXPECT(!history.load(path));
+    EXPECT_EQ(history.getCount(), 0u);
+    EXPECT(!history.load("/tmp/ostest-history-missing"));
+    ::unlink(path);
+}
+#endif
+
+#if OSTEST_STD_THREADS
+TEST(HistorySuite, ParallelHistoryTest)
+{
+    auto tests = selftest::_getHistoryTests();
+
+    // Runners record each test as it completes
+    TestHistory history{};
+    ParallelRunner runner(2, &history, true);
+    EXPECT_EQ(runner.getHistory(), &history);
+    runner.run(tests.data(), tests.size());
+
+    EXPECT_EQ(history.getCount(), tests.size());
+    EXPECT(history.hasFailed(*tests[3]));
+    EXPECT(!history.hasFailed(*tests[0]));
+}
+#endif
+#endif
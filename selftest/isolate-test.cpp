@@ -0,0 +1,143 @@
+/* isolate-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <csignal>
+#include <cstring>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace ostest;
+
+#if OSTEST_POSIX
+namespace selftest
+{
+    TEST_SUITE(_IsolatedSuite)
+
+    TEST_EX(::selftest, _IsolatedSuite, _TestPass1) {
+        EXPECT(true);
+    }
+    TEST_EX(::selftest, _IsolatedSuite, _TestFail1) {
+        EXPECT_EQ(1, 2);
+    }
+    TEST_EX(::selftest, _IsolatedSuite, _TestCrash) {
+        EXPECT(true);
+        std::raise(SIGKILL);
+    }
+    TEST_EX(::selftest, _IsolatedSuite, _TestPass2) {
+        EXPECT(true);
+        EXPECT_NEQ(1, 2);
+    }
+    TEST_EX(::selftest, _IsolatedSuite, _TestPass3) {
+        EXPECT(true);
+    }
+
+    // Records the results of tests run in child processes
+    class _IsolatedRecordingRunner : public IsolatedRunner
+    {
+    public:
+        std::vector<const TestInfo*> completed{};
+        std::vector<TestResult> results{};
+
+        using IsolatedRunner::IsolatedRunner;
+
+    protected:
+        void notifyComplete(const TestInfo& info, const TestResult& result) override
+        {
+            completed.push_back(&info);
+            results.push_back(result);
+        }
+    };
+}
+
+
+TEST_SUITE(IsolatedSuite)
+
+TEST(IsolatedSuite, IsolatedRunTest)
+{
+    std::vector<const TestInfo*> tests{};
+
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_IsolatedSuite") != 0) continue;
+        for (auto& test : suite.tests()) tests.push_back(&test);
+    }
+    ASSERT_EQ(tests.size(), 5u);
+
+    // All tests in a single batch, so those after the crash must be rescheduled
+    selftest::_IsolatedRecordingRunner runner(2, 5);
+    runner.run(tests.data(), tests.size());
+
+    ASSERT_EQ(runner.completed.size(), tests.size());
+    for (size_t i = 0; i < tests.size(); i++)
+    {
+        const TestInfo& test = *runner.completed[i];
+        const TestResult& result = runner.results[i];
+        printTestResult(test, true, result);
+
+        if (std::strcmp(test.name, "_TestPass1") == 0) {
+            EXPECT_EQ_ALL(countAssertions(result), 1u);
+            EXPECT_ALL(result.succeeded());
+        }
+        else if (std::strcmp(test.name, "_TestPass2") == 0) {
+            EXPECT_EQ_ALL(countAssertions(result), 2u);
+            EXPECT_ALL(result.succeeded());
+        }
+        else if (std::strcmp(test.name, "_TestPass3") == 0) {
+            EXPECT_ALL(result.succeeded());
+        }
+        else if (std::strcmp(test.name, "_TestFail1") == 0) {
+            ASSERT_NEQ_ALL(result.getFirstFailure(), nullptr);
+            EXPECT_EQ_ALL(result.getFirstFailure()->line, test.line + 1);
+            EXPECT_ZERO_ALL(std::strcmp(result.getFirstFailure()->getMessage(),
+                "Expected 1 == 2."));
+        }
+        else
+        {
+            ASSERT_ZERO_ALL(std::strcmp(test.name, "_TestCrash"));
+            ASSERT_NEQ_ALL(result.getFirstFailure(), nullptr);
+            EXPECT_ZERO_ALL(std::strcmp(result.getFirstFailure()->expression,
+                "<process terminated>"));
+            EXPECT_EQ_ALL(countAssertions(result), 1u);
+        }
+    }
+}
+
+TEST(IsolatedSuite, StartFailureTest)
+{
+    std::vector<const TestInfo*> tests{};
+
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_IsolatedSuite") != 0) continue;
+        for (auto& test : suite.tests()) tests.push_back(&test);
+    }
+    ASSERT_EQ(tests.size(), 5u);
+
+    // Limit open files to those already open, so that no result pipe can be created
+    rlimit limit{};
+    ASSERT_ZERO(::getrlimit(RLIMIT_NOFILE, &limit));
+    int lowestFree = ::dup(0);
+    ASSERT_GTEQ(lowestFree, 0);
+    ::close(lowestFree);
+
+    rlimit lowered = limit;
+    lowered.rlim_cur = static_cast<rlim_t>(lowestFree);
+    ASSERT_ZERO(::setrlimit(RLIMIT_NOFILE, &lowered));
+
+    selftest::_IsolatedRecordingRunner runner(2, 2);
+    runner.run(tests.data(), tests.size());
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+
+    // Every test is still reported
+    const char* prefix = "Could not start a child process to run the test: ";
+    ASSERT_EQ(runner.completed.size(), tests.size());
+    for (size_t i = 0; i < tests.size(); i++)
+    {
+        const TestResult& result = runner.results[i];
+        EXPECT_EQ_ALL(runner.completed[i], tests[i]);
+        ASSERT_NEQ_ALL(result.getFirstFailure(), nullptr);
+        EXPECT_ZERO_ALL(std::strcmp(result.getFirstFailure()->expression, "<process not started>"));
+        EXPECT_ZERO_ALL(std::strncmp(result.getFirstFailure()->getMessage(), prefix, std::strlen(prefix)));
+    }
+}
+#endif
@@ -0,0 +1,136 @@
+/* log-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if OSTEST_POSIX
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+using namespace ostest;
+
+#if !OSTEST_NO_ALLOC
+namespace selftest
+{
+    TEST_SUITE(_LogSuite)
+    TEST_SUITE(_LogSuite2)
+
+    TEST_EX(::selftest, _LogSuite, _Pass) {
+        EXPECT(true);
+    }
+    TEST_EX(::selftest, _LogSuite, _Fail) {
+        EXPECT(false);
+        EXPECT(true);
+        EXPECT_EQ(1, 2);
+    }
+    TEST_EX(::selftest, _LogSuite2, _Fail) {
+        EXPECT(false);
+    }
+
+    static void _appendLog(void* context, const char* data, size_t length) {
+        static_cast<std::string*>(context)->append(data, length);
+    }
+
+    // Writes the results of the internal log tests as a binary log
+    static std::string _writeLog()
+    {
+        std::string output{};
+        char buffer[256];
+        BinaryReporter reporter(_appendLog, &output, buffer, sizeof(buffer));
+
+        setTimingClocks(nullptr, nullptr);
+        reporter.begin();
+        for (auto& suiteInfo : getSuites())
+        {
+            if (std::strncmp(suiteInfo.name, "_LogSuite", 9) != 0) continue;
+
+            auto suite = suiteInfo.getSingletonSmartPtr();
+            for (auto& test : suiteInfo.tests()) {
+                reporter.report(test, TestRunner(*suite, test).run());
+            }
+        }
+        reporter.end();
+        resetTimingClocks();
+        return output;
+    }
+}
+
+
+TEST_SUITE(LogSuite)
+
+TEST(LogSuite, ReadTest)
+{
+    // Checks the contents of a log of the internal log tests
+    auto checkLog = [&](const ResultLog& log)
+    {
+        ASSERT_ALL(log.valid());
+        ASSERT_EQ_ALL(log.getTestCount(), 3u);
+
+        LogTest pass = log.getTest(0);
+        EXPECT_ZERO_ALL(std::strcmp(pass.suite, "_LogSuite"));
+        EXPECT_ZERO_ALL(std::strcmp(pass.name, "_Pass"));
+        EXPECT_ALL(pass.passed);
+        EXPECT_EQ_ALL(pass.assertionCount, 1u);
+
+        LogTest fail = log.getTest(1);
+        EXPECT_ZERO_ALL(std::strcmp(fail.name, "_Fail"));
+        EXPECT_ALL(!fail.passed);
+        EXPECT_EQ_ALL(fail.assertionCount, 3u);
+        EXPECT_EQ_ALL(fail.failureCount, 2u);
+
+        LogAssertion assertion = log.getAssertion(fail, 2);
+        EXPECT_ZERO_ALL(std::strcmp(assertion.expression, "(1) == (2)"));
+        EXPECT_ZERO_ALL(std::strcmp(assertion.message, "Expected 1 == 2."));
+        EXPECT_EQ_ALL(assertion.line, fail.line + 3);
+        EXPECT_ALL(!assertion.passed);
+
+        // Only the failures of the given suite are visited
+        std::vector<int> lines{};
+        log.forEachFailure("_LogSuite", [&](const LogTest& test, const LogAssertion& failure) {
+            EXPECT_ZERO_ALL(std::strcmp(test.suite, "_LogSuite"));
+            lines.push_back(failure.line);
+        });
+        ASSERT_EQ_ALL(lines.size(), 2u);
+        EXPECT_EQ_ALL(lines[0], fail.line + 1);
+        EXPECT_EQ_ALL(lines[1], fail.line + 3);
+
+        unsigned int count = 0;
+        log.forEachFailure("_LogSuite3", [&](const LogTest&, const LogAssertion&) { count++; });
+        EXPECT_EQ_ALL(count, 0u);
+    };
+
+    std::string output = selftest::_writeLog();
+
+    // Copy into aligned storage
+    std::vector<unsigned long long> storage(output.size() / sizeof(unsigned long long) + 1);
+    std::memcpy(storage.data(), output.data(), output.size());
+    checkLog(ResultLog(storage.data(), output.size()));
+
+    // Strings are only stored once
+    size_t occurrences = 0;
+    for (size_t i = output.find("_LogSuite"); i != std::string::npos; i = output.find("_LogSuite", i + 1)) {
+        occurrences++;
+    }
+    EXPECT_EQ(occurrences, 2u);
+
+    // Truncated logs are rejected
+    EXPECT(!ResultLog(storage.data(), output.size() - 8).valid());
+    EXPECT(!ResultLog(storage.data(), 0).valid());
+
+#if OSTEST_POSIX
+    // Logs can be memory-mapped from a file
+    char path[] = "/tmp/ostest-log-XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT(fd >= 0);
+
+    writeToFile(&fd, output.data(), output.size());
+    ::close(fd);
+    checkLog(ResultLog(path));
+    ::unlink(path);
+
+    EXPECT(!ResultLog("/tmp/ostest-log-missing").valid());
+#endif
+}
+#endif
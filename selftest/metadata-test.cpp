@@ -8,6 +8,11 @@ namespace selftest
 {
     TEST_SUITE(_MetadataSuite);
 
+    // Metadata names are hashed at compile time
+    static_assert(_ostest_internal::_hashName("") == 0x811C9DC5u, "Unexpected FNV-1a hash");
+    static_assert(_ostest_internal::_hashName("a") == 0xE40C292Cu, "Unexpected FNV-1a hash");
+    static_assert(METADATA_NAME("a").hash == 0xE40C292Cu, "Unexpected FNV-1a hash");
+
     struct test_struct
     {
         unsigned long i = 0xC0FFEE;
@@ -22,36 +27,36 @@ namespace selftest
 
     TEST_EX(::selftest, _MetadataSuite, _TestNoMetadataPass)
     {
-        EXPECT_EQ(getMetadata<int>(""), nullptr);
+        EXPECT_EQ(getMetadata<int>(METADATA_NAME("")), nullptr);
     }
 
     TEST_EX(::selftest, _MetadataSuite, _TestCreateMetadataPass)
     {
-        static Metadata<int> zero(*this, "zero", 0);
+        static Metadata<int> zero(*this, METADATA_NAME("zero"), 0);
     }
 
     TEST_EX(::selftest, _MetadataSuite, _TestGetMetadataPass)
     {
-        static Metadata<int> value(*this, "value", 0xC0FFEE);
+        static Metadata<int> value(*this, METADATA_NAME("value"), 0xC0FFEE);
 
-        EXPECT_EQ(getMetadata<int>(""), nullptr);
+        EXPECT_EQ(getMetadata<int>(METADATA_NAME("")), nullptr);
 
-        ASSERT_NEQ(getMetadata<int>("value"), nullptr);
-        EXPECT_EQ(getMetadata<int>("value")->value, 0xC0FFEE);
-        EXPECT_ZERO(std::strcmp(getMetadata<int>("value")->name, "value"));
+        ASSERT_NEQ(getMetadata<int>(METADATA_NAME("value")), nullptr);
+        EXPECT_EQ(getMetadata<int>(METADATA_NAME("value"))->value, 0xC0FFEE);
+        EXPECT_ZERO(std::strcmp(getMetadata<int>(METADATA_NAME("value"))->name, "value"));
     }
 
     TEST_EX(::selftest, _MetadataSuite, _TestSetMetadataPass)
     {
-        static Metadata<int> value(*this, "value", 0);
-        ASSERT_NEQ(getMetadata<int>("value"), nullptr);
+        static Metadata<int> value(*this, METADATA_NAME("value"), 0);
+        ASSERT_NEQ(getMetadata<int>(METADATA_NAME("value")), nullptr);
 
-        EXPECT_EQ(getMetadata<int>("value")->value, 0);
+        EXPECT_EQ(getMetadata<int>(METADATA_NAME("value"))->value, 0);
 
-        getMetadata<int>("value")->value = 0xC0FFEE;
-        ASSERT_NEQ(getMetadata<int>("value"), nullptr);
+        getMetadata<int>(METADATA_NAME("value"))->value = 0xC0FFEE;
+        ASSERT_NEQ(getMetadata<int>(METADATA_NAME("value")), nullptr);
 
-        EXPECT_EQ(getMetadata<int>("value")->value, 0xC0FFEE);
+        EXPECT_EQ(getMetadata<int>(METADATA_NAME("value"))->value, 0xC0FFEE);
     }
 
     TEST_EX(::selftest, _MetadataSuite, _TestMultipleMetadataPass)
@@ -67,49 +72,49 @@ namespace selftest
 
         auto f4 = [](unsigned int i) { return (i * 2) + 1; };
 
-        static Metadata<T1> m1(*this, "m1", v1);
-        static Metadata<T2> m2(*this, "m2", v2);
-        static Metadata<T3> m3(*this, "m3", v3);
-        static Metadata<T4> m4(*this, "m4");
+        static Metadata<T1> m1(*this, METADATA_NAME("m1"), v1);
+        static Metadata<T2> m2(*this, METADATA_NAME("m2"), v2);
+        static Metadata<T3> m3(*this, METADATA_NAME("m3"), v3);
+        static Metadata<T4> m4(*this, METADATA_NAME("m4"));
 
-        EXPECT_NEQ(getMetadata<T1>("m1"), nullptr);
-        EXPECT_NEQ(getMetadata<T2>("m2"), nullptr);
-        EXPECT_NEQ(getMetadata<T3>("m3"), nullptr);
-        EXPECT_NEQ(getMetadata<T4>("m4"), nullptr);
+        EXPECT_NEQ(getMetadata<T1>(METADATA_NAME("m1")), nullptr);
+        EXPECT_NEQ(getMetadata<T2>(METADATA_NAME("m2")), nullptr);
+        EXPECT_NEQ(getMetadata<T3>(METADATA_NAME("m3")), nullptr);
+        EXPECT_NEQ(getMetadata<T4>(METADATA_NAME("m4")), nullptr);
         ASSERT(getResult().succeeded());
 
         // Assign array value
-        auto& array = getMetadata<T4>("m4")->value;
+        auto& array = getMetadata<T4>(METADATA_NAME("m4"))->value;
         for (unsigned int i = 0; i < sizeof(T4) / sizeof(T4{}[0]); i++) {
             array[i] = f4(i);
         }
 
         // Mix order
-        EXPECT_ZERO(std::strcmp(getMetadata<T3>("m3")->name, "m3"));
-        EXPECT_ZERO(std::strcmp(getMetadata<T4>("m4")->name, "m4"));
-        EXPECT_ZERO(std::strcmp(getMetadata<T1>("m1")->name, "m1"));
-        EXPECT_ZERO(std::strcmp(getMetadata<T2>("m2")->name, "m2"));
+        EXPECT_ZERO(std::strcmp(getMetadata<T3>(METADATA_NAME("m3"))->name, "m3"));
+        EXPECT_ZERO(std::strcmp(getMetadata<T4>(METADATA_NAME("m4"))->name, "m4"));
+        EXPECT_ZERO(std::strcmp(getMetadata<T1>(METADATA_NAME("m1"))->name, "m1"));
+        EXPECT_ZERO(std::strcmp(getMetadata<T2>(METADATA_NAME("m2"))->name, "m2"));
 
-        EXPECT_EQ(getMetadata<T1>("m1")->value, v1);
-        EXPECT_EQ(getMetadata<T3>("m3")->value, v3);
-        EXPECT_EQ(getMetadata<T2>("m2")->value, v2);
+        EXPECT_EQ(getMetadata<T1>(METADATA_NAME("m1"))->value, v1);
+        EXPECT_EQ(getMetadata<T3>(METADATA_NAME("m3"))->value, v3);
+        EXPECT_EQ(getMetadata<T2>(METADATA_NAME("m2"))->value, v2);
 
         for (unsigned int i = 0; i < sizeof(T4) / sizeof(T4{}[0]); i++)
         {
-            EXPECT_ALL_OR_ASSERT(getMetadata<T4>("m4")->value[i] == f4(i));
+            EXPECT_ALL_OR_ASSERT(getMetadata<T4>(METADATA_NAME("m4"))->value[i] == f4(i));
         }
     }
 
     TEST_EX(::selftest, _MetadataSuite, _TestTransientMetadataOnlyPass)
     {
         {
-            Metadata<bool> m1(*this, "m1", true);
-            ASSERT_NEQ(getMetadata<bool>("m1"), nullptr);
-            EXPECT_ZERO(std::strcmp(getMetadata<bool>("m1")->name, "m1"));
-            EXPECT_EQ(getMetadata<bool>("m1")->value, true);
+            Metadata<bool> m1(*this, METADATA_NAME("m1"), true);
+            ASSERT_NEQ(getMetadata<bool>(METADATA_NAME("m1")), nullptr);
+            EXPECT_ZERO(std::strcmp(getMetadata<bool>(METADATA_NAME("m1"))->name, "m1"));
+            EXPECT_EQ(getMetadata<bool>(METADATA_NAME("m1"))->value, true);
         }
 
-        EXPECT_EQ(getMetadata<bool>("m1"), nullptr);
+        EXPECT_EQ(getMetadata<bool>(METADATA_NAME("m1")), nullptr);
     }
 
     TEST_EX(::selftest, _MetadataSuite, _TestTransientMetadataPass)
@@ -120,29 +125,29 @@ namespace selftest
         using T4 = int[3];
 
         // Test for missing metadata
-        EXPECT_EQ(getInfo().getMetadata<T1>(""), nullptr);
+        EXPECT_EQ(getInfo().getMetadata<T1>(METADATA_NAME("")), nullptr);
 
-        Metadata<T1> m1(*this, "m1");
+        Metadata<T1> m1(*this, METADATA_NAME("m1"));
         {
-            Metadata<T2> m2(*this, "m2");
+            Metadata<T2> m2(*this, METADATA_NAME("m2"));
         }
-        Metadata<T3> m3(*this, "m3");
+        Metadata<T3> m3(*this, METADATA_NAME("m3"));
         {
-            Metadata<T4> m4(*this, "m4");
+            Metadata<T4> m4(*this, METADATA_NAME("m4"));
         }
 
-        EXPECT_EQ(getMetadata<T2>("m2"), nullptr);
-        EXPECT_EQ(getMetadata<T4>("m4"), nullptr);
-        ASSERT_NEQ(getMetadata<T1>("m1"), nullptr);
-        ASSERT_NEQ(getMetadata<T3>("m3"), nullptr);
+        EXPECT_EQ(getMetadata<T2>(METADATA_NAME("m2")), nullptr);
+        EXPECT_EQ(getMetadata<T4>(METADATA_NAME("m4")), nullptr);
+        ASSERT_NEQ(getMetadata<T1>(METADATA_NAME("m1")), nullptr);
+        ASSERT_NEQ(getMetadata<T3>(METADATA_NAME("m3")), nullptr);
 
-        EXPECT_ZERO(std::strcmp(getMetadata<T1>("m1")->name, "m1"));
-        EXPECT_ZERO(std::strcmp(getMetadata<T3>("m3")->name, "m3"));
+        EXPECT_ZERO(std::strcmp(getMetadata<T1>(METADATA_NAME("m1"))->name, "m1"));
+        EXPECT_ZERO(std::strcmp(getMetadata<T3>(METADATA_NAME("m3"))->name, "m3"));
 
-        EXPECT_EQ(getMetadata<T1>("m1")->value, T1 {});
-        EXPECT_EQ(getMetadata<T3>("m3")->value, T3 {});
+        EXPECT_EQ(getMetadata<T1>(METADATA_NAME("m1"))->value, T1 {});
+        EXPECT_EQ(getMetadata<T3>(METADATA_NAME("m3"))->value, T3 {});
 
-        EXPECT_EQ(getInfo().getMetadata<T1>("1ab_cd"), nullptr);
+        EXPECT_EQ(getInfo().getMetadata<T1>(METADATA_NAME("1ab_cd")), nullptr);
     }
 
     TEST_EX(::selftest, _MetadataSuite, _InfoMetadataPass)
@@ -152,34 +157,34 @@ namespace selftest
         using T3 = test_struct;
         using T4 = int[3];
 
-        static Metadata<T1> m1(*this, "m1");
-        static Metadata<T2> m2(*this, "m2");
-        static Metadata<T3> m3(*this, "m3");
-        static Metadata<T4> m4(*this, "m4");
+        static Metadata<T1> m1(*this, METADATA_NAME("m1"));
+        static Metadata<T2> m2(*this, METADATA_NAME("m2"));
+        static Metadata<T3> m3(*this, METADATA_NAME("m3"));
+        static Metadata<T4> m4(*this, METADATA_NAME("m4"));
 
-        EXPECT_NEQ(getInfo().getMetadata<T1>("m1"), nullptr);
-        EXPECT_NEQ(getInfo().getMetadata<T2>("m2"), nullptr);
-        EXPECT_NEQ(getInfo().getMetadata<T3>("m3"), nullptr);
-        EXPECT_NEQ(getInfo().getMetadata<T4>("m4"), nullptr);
+        EXPECT_NEQ(getInfo().getMetadata<T1>(METADATA_NAME("m1")), nullptr);
+        EXPECT_NEQ(getInfo().getMetadata<T2>(METADATA_NAME("m2")), nullptr);
+        EXPECT_NEQ(getInfo().getMetadata<T3>(METADATA_NAME("m3")), nullptr);
+        EXPECT_NEQ(getInfo().getMetadata<T4>(METADATA_NAME("m4")), nullptr);
         ASSERT(getResult().succeeded());
 
         // Mix order
-        EXPECT_ZERO(std::strcmp(getInfo().getMetadata<T3>("m3")->name, "m3"));
-        EXPECT_ZERO(std::strcmp(getInfo().getMetadata<T4>("m4")->name, "m4"));
-        EXPECT_ZERO(std::strcmp(getInfo().getMetadata<T1>("m1")->name, "m1"));
-        EXPECT_ZERO(std::strcmp(getInfo().getMetadata<T2>("m2")->name, "m2"));
+        EXPECT_ZERO(std::strcmp(getInfo().getMetadata<T3>(METADATA_NAME("m3"))->name, "m3"));
+        EXPECT_ZERO(std::strcmp(getInfo().getMetadata<T4>(METADATA_NAME("m4"))->name, "m4"));
+        EXPECT_ZERO(std::strcmp(getInfo().getMetadata<T1>(METADATA_NAME("m1"))->name, "m1"));
+        EXPECT_ZERO(std::strcmp(getInfo().getMetadata<T2>(METADATA_NAME("m2"))->name, "m2"));
 
-        EXPECT_EQ(getInfo().getMetadata<T1>("m1")->value, T1 {});
-        EXPECT_EQ(getInfo().getMetadata<T3>("m3")->value, T3 {});
-        EXPECT_EQ(getInfo().getMetadata<T2>("m2")->value, T2 {});
+        EXPECT_EQ(getInfo().getMetadata<T1>(METADATA_NAME("m1"))->value, T1 {});
+        EXPECT_EQ(getInfo().getMetadata<T3>(METADATA_NAME("m3"))->value, T3 {});
+        EXPECT_EQ(getInfo().getMetadata<T2>(METADATA_NAME("m2"))->value, T2 {});
 
         for (unsigned int i = 0; i < sizeof(T4) / sizeof(T4{}[0]); i++)
         {
-            EXPECT_ALL_OR_ASSERT(getInfo().getMetadata<T4>("m4")->value[i] == 0);
+            EXPECT_ALL_OR_ASSERT(getInfo().getMetadata<T4>(METADATA_NAME("m4"))->value[i] == 0);
         }
 
         // Test for missing metadata
-        EXPECT_EQ(getInfo().getMetadata<T1>(""), nullptr);
+        EXPECT_EQ(getInfo().getMetadata<T1>(METADATA_NAME("")), nullptr);
     }
 }
 
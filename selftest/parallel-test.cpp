@@ -0,0 +1,99 @@
+/* parallel-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+using namespace ostest;
+
+#if OSTEST_STD_THREADS
+namespace selftest
+{
+    class _ParallelSuite : public TestSuite
+    {
+    public:
+        int value = 0;
+
+        void setUp() override { value = 1; }
+        void tearDown() override { value = 0; }
+    };
+
+#define PARALLEL_TEST(name) \
+    TEST_EX(::selftest, _ParallelSuite, name) \
+    { \
+        ASSERT_EQ(suite.value, 1); \
+        suite.value++; \
+        for (int i = 0; i < 20; i++) EXPECT_ALL(i < 20); \
+        EXPECT_EQ(suite.value, 2); \
+    }
+
+    PARALLEL_TEST(_Test01) PARALLEL_TEST(_Test02) PARALLEL_TEST(_Test03)
+    PARALLEL_TEST(_Test04) PARALLEL_TEST(_Test05) PARALLEL_TEST(_Test06)
+    PARALLEL_TEST(_Test07) PARALLEL_TEST(_Test08) PARALLEL_TEST(_Test09)
+    PARALLEL_TEST(_Test10) PARALLEL_TEST(_Test11) PARALLEL_TEST(_Test12)
+
+#undef PARALLEL_TEST
+
+    TEST_EX(::selftest, _ParallelSuite, _TestFail)
+    {
+        static Metadata<TestExpect> _(*this, METADATA_NAME("expect"), TestExpect::AllFail);
+        EXPECT(false);
+    }
+
+    // Records the results of tests run in parallel
+    class _ParallelRecordingRunner : public ParallelRunner
+    {
+    public:
+        std::mutex lock{};
+        std::vector<const TestInfo*> completed{};
+        bool allAsExpected = true;
+
+        using ParallelRunner::ParallelRunner;
+
+    protected:
+        void notifyComplete(const TestInfo& info, const TestResult& result) override
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            completed.push_back(&info);
+            allAsExpected = allAsExpected && testPassed(info, result);
+            printTestResult(info, testPassed(info, result), result);
+        }
+    };
+}
+
+
+TEST_SUITE(ParallelSuite)
+
+TEST(ParallelSuite, ParallelRunTest)
+{
+    std::vector<const TestInfo*> tests{};
+
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_ParallelSuite") != 0) continue;
+        for (auto& test : suite.tests()) tests.push_back(&test);
+    }
+    ASSERT_EQ(tests.size(), 13u);
+
+    selftest::_ParallelRecordingRunner runner(4);
+    EXPECT_EQ(runner.getThreadCount(), 4u);
+    runner.run(tests.data(), tests.size());
+
+    // Each test must have completed exactly once
+    EXPECT_EQ(runner.completed.size(), tests.size());
+    for (auto* test : tests)
+    {
+        size_t count = 0;
+        for (auto* completed : runner.completed) {
+            if (completed == test) count++;
+        }
+        EXPECT_EQ_ALL(count, 1u);
+    }
+    EXPECT(runner.allAsExpected);
+}
+
+TEST(ParallelSuite, DefaultThreadCountTest)
+{
+    EXPECT_NEQ(ParallelRunner().getThreadCount(), 0u);
+}
+#endif
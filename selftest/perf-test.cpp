@@ -0,0 +1,52 @@
+/* perf-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <cstring>
+
+using namespace ostest;
+
+#if OSTEST_PERF_COUNTERS && defined(__linux__)
+namespace selftest
+{
+    static volatile unsigned long long perfSink = 0;
+
+    TEST_SUITE(_PerfSuite)
+
+    TEST_EX(::selftest, _PerfSuite, _Busy)
+    {
+        for (unsigned long long i = 0; i < 10000000; i++) perfSink += i;
+    }
+}
+
+TEST_SUITE(PerfSuite)
+
+TEST(PerfSuite, CounterTest)
+{
+    // Counters may not be permitted at all, in which case none are given
+    PerfCounters counters{};
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_PerfSuite") != 0) continue;
+
+        auto suiteInstance = suite.getSingletonSmartPtr();
+        for (auto& test : suite.tests())
+        {
+            auto result = TestRunner(*suiteInstance, test).run();
+            EXPECT(result.succeeded());
+            if (result.getPerfCounters() != nullptr) counters = *result.getPerfCounters();
+        }
+        break;
+    }
+    if (counters.measured == 0) return;
+
+    // Either the hardware or the software counters are read
+    bool hardware = counters.has(PerfCounter::Cycles) || counters.has(PerfCounter::Instructions) ||
+        counters.has(PerfCounter::BranchMisses) || counters.has(PerfCounter::CacheMisses);
+    bool software = counters.has(PerfCounter::TaskClock) || counters.has(PerfCounter::PageFaults) ||
+        counters.has(PerfCounter::ContextSwitches);
+    EXPECT(hardware != software);
+
+    if (counters.has(PerfCounter::Instructions)) EXPECT(counters.instructions > 10000000u);
+    if (counters.has(PerfCounter::TaskClock)) EXPECT_NONZERO(counters.taskClock);
+    if (!counters.has(PerfCounter::Cycles)) EXPECT_ZERO(counters.instructionsPerCycle());
+}
+#endif
@@ -0,0 +1,138 @@
+/* report-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace ostest;
+
+namespace selftest
+{
+    TEST_SUITE(_ReportSuite)
+    TEST_SUITE(_ReportSuite2)
+
+    TEST_EX(::selftest, _ReportSuite, _Pass) {
+        EXPECT(true);
+    }
+    TEST_EX(::selftest, _ReportSuite, _Fail) {
+        EXPECT_EQ(1, 2);
+    }
+    TEST_EX(::selftest, _ReportSuite2, _Escape) {
+        EXPECT(std::strlen("<&\"\t>") == 0);
+    }
+
+    // Collects reporter output, recording the number of writes
+    struct _ReportOutput
+    {
+        std::string data{};
+        unsigned int writes = 0;
+
+        static void write(void* context, const char* data, size_t length)
+        {
+            auto& output = *static_cast<_ReportOutput*>(context);
+            output.data.append(data, length);
+            output.writes++;
+        }
+    };
+
+    // Runs the internal report tests, passing each result to the reporter
+    static void _runReported(Reporter& reporter, std::vector<const TestInfo*>& tests)
+    {
+        tests.clear();
+        setTimingClocks(nullptr, nullptr);
+        reporter.begin();
+
+        for (auto& suiteInfo : getSuites())
+        {
+            if (std::strncmp(suiteInfo.name, "_ReportSuite", 12) != 0) continue;
+
+            auto suite = suiteInfo.getSingletonSmartPtr();
+            for (auto& test : suiteInfo.tests())
+            {
+                tests.push_back(&test);
+                reporter.report(test, TestRunner(*suite, test).run());
+            }
+        }
+        reporter.end();
+        resetTimingClocks();
+    }
+}
+
+
+TEST_SUITE(ReportSuite)
+
+TEST(ReportSuite, JUnitTest)
+{
+    std::vector<const TestInfo*> tests{};
+    char buffer[4096];
+
+    selftest::_ReportOutput output{};
+    JUnitReporter reporter(selftest::_ReportOutput::write, &output, buffer, sizeof(buffer));
+    selftest::_runReported(reporter, tests);
+    ASSERT_EQ(tests.size(), 3u);
+
+    std::string file = tests[0]->file;
+    std::string expected =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n"
+        "  <testsuite name=\"_ReportSuite\">\n"
+        "    <testcase classname=\"_ReportSuite\" name=\"_Pass\" file=\"" + file +
+            "\" line=\"" + std::to_string(tests[0]->line) + "\" time=\"0.000000000\"/>\n"
+        "    <testcase classname=\"_ReportSuite\" name=\"_Fail\" file=\"" + file +
+            "\" line=\"" + std::to_string(tests[1]->line) + "\" time=\"0.000000000\">\n"
+        "      <failure message=\"Expected 1 == 2.\" type=\"assertion\">" + file + ":" +
+            std::to_string(tests[1]->line + 1) + ": (1) == (2)</failure>\n"
+        "    </testcase>\n"
+        "  </testsuite>\n"
+        "  <testsuite name=\"_ReportSuite2\">\n"
+        "    <testcase classname=\"_ReportSuite2\" name=\"_Escape\" file=\"" + file +
+            "\" line=\"" + std::to_string(tests[2]->line) + "\" time=\"0.000000000\">\n"
+        "      <failure message=\"The assertion failed.\" type=\"assertion\">" + file + ":" +
+            std::to_string(tests[2]->line + 1) + ": std::strlen(&quot;&lt;&amp;\\&quot;\\t&gt;&quot;) == 0</failure>\n"
+        "    </testcase>\n"
+        "  </testsuite>\n"
+        "</testsuites>\n";
+
+    EXPECT(output.data == expected);
+    // Output is only written once flushed
+    EXPECT_EQ(output.writes, 1u);
+
+    // Small buffers are flushed as they fill, without altering the output
+    char smallBuffer[8];
+    selftest::_ReportOutput smallOutput{};
+    JUnitReporter smallReporter(selftest::_ReportOutput::write, &smallOutput, smallBuffer, sizeof(smallBuffer));
+    selftest::_runReported(smallReporter, tests);
+
+    EXPECT(smallOutput.data == expected);
+    EXPECT(smallOutput.writes > 1u);
+}
+
+TEST(ReportSuite, JsonTest)
+{
+    std::vector<const TestInfo*> tests{};
+    char buffer[4096];
+
+    selftest::_ReportOutput output{};
+    JsonReporter reporter(selftest::_ReportOutput::write, &output, buffer, sizeof(buffer));
+    selftest::_runReported(reporter, tests);
+    ASSERT_EQ(tests.size(), 3u);
+
+    std::string file = tests[0]->file;
+    std::string expected =
+        "{\"suite\":\"_ReportSuite\",\"test\":\"_Pass\",\"file\":\"" + file + "\",\"line\":" +
+            std::to_string(tests[0]->line) + ",\"passed\":true,\"assertions\":1,"
+            "\"wallTime\":0,\"cpuTime\":0,\"failures\":[]}\n"
+        "{\"suite\":\"_ReportSuite\",\"test\":\"_Fail\",\"file\":\"" + file + "\",\"line\":" +
+            std::to_string(tests[1]->line) + ",\"passed\":false,\"assertions\":1,"
+            "\"wallTime\":0,\"cpuTime\":0,\"failures\":[{\"expression\":\"(1) == (2)\",\"file\":\"" +
+            file + "\",\"line\":" + std::to_string(tests[1]->line + 1) +
+            ",\"message\":\"Expected 1 == 2.\"}]}\n"
+        "{\"suite\":\"_ReportSuite2\",\"test\":\"_Escape\",\"file\":\"" + file + "\",\"line\":" +
+            std::to_string(tests[2]->line) + ",\"passed\":false,\"assertions\":1,"
+            "\"wallTime\":0,\"cpuTime\":0,\"failures\":[{\"expression\":"
+            "\"std::strlen(\\\"<&\\\\\\\"\\\\t>\\\") == 0\",\"file\":\"" +
+            file + "\",\"line\":" + std::to_string(tests[2]->line + 1) +
+            ",\"message\":\"The assertion failed.\"}]}\n";
+
+    EXPECT(output.data == expected);
+    EXPECT_EQ(output.writes, 1u);
+}
@@ -0,0 +1,135 @@
+/* rerun-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <cstring>
+
+#if OSTEST_POSIX
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+using namespace ostest;
+
+#if OSTEST_POSIX && !OSTEST_NO_ALLOC
+namespace selftest
+{
+    static bool rerunFailing = true;
+    static unsigned int rerunCount = 0;
+    static unsigned int passingSuiteCount = 0;
+
+    TEST_SUITE(_RerunSuiteA)
+
+    class _RerunSuiteB : public TestSuite
+    {
+    public:
+        _RerunSuiteB() { passingSuiteCount++; }
+    };
+
+    TEST_EX(::selftest, _RerunSuiteA, _Pass1) {
+        rerunCount++;
+        EXPECT(true);
+    }
+    TEST_EX(::selftest, _RerunSuiteA, _Fail1) {
+        rerunCount++;
+        EXPECT(!rerunFailing);
+    }
+    TEST_EX(::selftest, _RerunSuiteA, _Fail2) {
+        rerunCount++;
+        EXPECT(!rerunFailing);
+    }
+    TEST_EX(::selftest, _RerunSuiteB, _Pass1) {
+        rerunCount++;
+        EXPECT(true);
+    }
+
+    // Runs the internal rerun tests, recording each in the given state
+    static void _runAndRecord(RerunState& state)
+    {
+        for (auto& suiteInfo : getSuites())
+        {
+            if (std::strncmp(suiteInfo.name, "_RerunSuite", 11) != 0) continue;
+
+            auto suite = suiteInfo.getSingletonSmartPtr();
+            for (auto& test : suiteInfo.tests()) state.record(test, TestRunner(*suite, test).run());
+        }
+    }
+}
+
+
+TEST_SUITE(RerunSuite)
+
+TEST(RerunSuite, RerunFailedTest)
+{
+    char path[] = "/tmp/ostest-failed-XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT(fd >= 0);
+    ::close(fd);
+    ::unlink(path);
+
+    selftest::rerunFailing = true;
+    {
+        // Nothing has failed before the first run
+        RerunState state(path);
+        EXPECT_EQ(state.getCount(), 0u);
+
+        selftest::_runAndRecord(state);
+        EXPECT_EQ(state.getFailedCount(), 2u);
+        EXPECT(state.save());
+    }
+    {
+        // Only the failed tests are selected, in registration order
+        RerunState state(path);
+        ASSERT_EQ(state.getCount(), 2u);
+        EXPECT_ZERO(std::strcmp(state.tests()[0]->name, "_Fail1"));
+        EXPECT_ZERO(std::strcmp(state.tests()[1]->name, "_Fail2"));
+        EXPECT_ZERO(std::strcmp(state.tests()[0]->suite.name, "_RerunSuiteA"));
+
+        // Suites without failed tests are not created
+        selftest::rerunCount = 0;
+        selftest::passingSuiteCount = 0;
+        state.run();
+        EXPECT_EQ(selftest::rerunCount, 2u);
+        EXPECT_EQ(selftest::passingSuiteCount, 0u);
+
+        // Tests which now pass are removed
+        selftest::rerunFailing = false;
+        for (size_t i = 0; i < state.getCount(); i++)
+        {
+            auto& test = *state.tests()[i];
+            auto suite = const_cast<SuiteInfo&>(test.suite).getSingletonSmartPtr();
+            state.record(test, TestRunner(*suite, test).run());
+        }
+        EXPECT_EQ(state.getFailedCount(), 0u);
+        EXPECT_EQ(state.getCount(), 2u);
+        EXPECT(state.save());
+    }
+    {
+        RerunState state(path);
+        EXPECT_EQ(state.getCount(), 0u);
+        EXPECT_EQ(state.getFailedCount(), 0u);
+    }
+    ::unlink(path);
+}
+
+TEST(RerunSuite, RemovedTestTest)
+{
+    char path[] = "/tmp/ostest-failed-XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT(fd >= 0);
+
+    // A test which is no longer registered is dropped when the state is saved
+    const char data[] = "ostest-failed 1\n1 _RerunSuiteA _Removed file.cpp\n";
+    ASSERT_EQ(::write(fd, data, sizeof(data) - 1), static_cast<ssize_t>(sizeof(data) - 1));
+    ::close(fd);
+    {
+        RerunState state(path);
+        EXPECT_EQ(state.getCount(), 0u);
+        EXPECT_EQ(state.getFailedCount(), 0u);
+        EXPECT(state.save());
+    }
+    {
+        RerunState state(path);
+        EXPECT_EQ(state.getFailedCount(), 0u);
+    }
+    ::unlink(path);
+}
+#endif
@@ -6,7 +6,7 @@ using namespace ostest;
 namespace selftest
 {
 #define TEST_EXPECT_ALL_FAIL \
-    static Metadata<TestExpect> _(*this, "expect", TestExpect::AllFail)
+    static Metadata<TestExpect> _(*this, METADATA_NAME("expect"), TestExpect::AllFail)
 
     class _ResultSuite : public TestSuite
     {
@@ -135,8 +135,8 @@ namespace selftest
 
         // Create array of tests expected to fail. Terminate with nullptr.
         static const Assertion* fails[] = { fail1, fail2, nullptr };
-        static Metadata<TestExpect> _1(*this, "expect", TestExpect::SomeFail);
-        static Metadata<const Assertion**> _2(*this, "fails", static_cast<const Assertion**>(fails));
+        static Metadata<TestExpect> _1(*this, METADATA_NAME("expect"), TestExpect::SomeFail);
+        static Metadata<const Assertion**> _2(*this, METADATA_NAME("fails"), static_cast<const Assertion**>(fails));
     }
 }
 
@@ -162,3 +162,390 @@ TEST(ResultSuite, ResultsTest)
         break;
     }
 }
+
+
+TEST(ResultSuite, SummaryTest)
+{
+    Assertion a{"a"}, b{"b"}, c{"c"};
+    TestResult result{};
+
+    a.evaluate(result, false);
+    b.evaluate(result, true);
+    c.evaluate(result, false);
+    EXPECT_EQ(result.getPassCount(), 1u);
+    EXPECT_EQ(result.getFailureCount(), 2u);
+    EXPECT_EQ(result.getFirstFailure(), &a);
+    EXPECT_EQ(result.getFinalFailure(), &c);
+
+    // Re-evaluated assertions move to the end, replacing their previous outcome
+    a.evaluate(result, true);
+    EXPECT_EQ(result.getPassCount(), 2u);
+    EXPECT_EQ(result.getFailureCount(), 1u);
+    EXPECT_EQ(result.getFirstFailure(), &c);
+    EXPECT_EQ(result.getFinalFailure(), &c);
+
+    c.evaluate(result, true);
+    EXPECT(result.succeeded());
+    EXPECT_EQ(result.getPassCount(), 3u);
+    EXPECT_EQ(result.getFirstFailure(), nullptr);
+    EXPECT_EQ(result.getFinalFailure(), nullptr);
+
+    b.evaluate(result, false);
+    EXPECT(!result.succeeded());
+    EXPECT_EQ(result.getFirstFailure(), &b);
+    EXPECT_EQ(result.getFinalFailure(), &b);
+
+    // The list is now a, c, b
+    const Assertion* expected[] = { &a, &c, &b };
+    size_t index = 0;
+    for (auto& assertion : result.getAssertions())
+    {
+        ASSERT_LT(index, 3u);
+        EXPECT_EQ(&assertion, expected[index]);
+        index++;
+    }
+    EXPECT_EQ(index, 3u);
+}
+
+
+namespace selftest
+{
+    class _TimingSuite : public TestSuite
+    {
+    public:
+        static volatile unsigned long sink;
+
+        void setUp() override {
+            for (unsigned long i = 0; i < 1000; i++) sink = sink + i;
+        }
+        void tearDown() override {
+            for (unsigned long i = 0; i < 1000; i++) sink = sink + i;
+        }
+    };
+    volatile unsigned long _TimingSuite::sink = 0;
+
+    TEST_EX(::selftest, _TimingSuite, _TimedTest)
+    {
+        for (unsigned long i = 0; i < 100000; i++) suite.sink = suite.sink + i;
+        EXPECT(true);
+    }
+
+    static unsigned long long wallTicks = 0;
+    static unsigned long long cpuTicks = 0;
+
+    static unsigned long long fakeWallClock() { return wallTicks += 1; }
+    static unsigned long long fakeCpuClock() { return cpuTicks += 10; }
+}
+
+TEST(ResultSuite, TimingTest)
+{
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_TimingSuite") != 0) continue;
+
+        auto suiteInstance = suite.getSingletonSmartPtr();
+        for (auto& test : suite.tests())
+        {
+            // Each phase is timed between consecutive clock readings
+            setTimingClocks(selftest::fakeWallClock, selftest::fakeCpuClock);
+            auto result = TestRunner(*suiteInstance, test).run();
+            resetTimingClocks();
+
+            auto& timings = result.getTimings();
+            EXPECT_EQ(timings.setUp.wallTime, 1u);
+            EXPECT_EQ(timings.testBody.wallTime, 1u);
+            EXPECT_EQ(timings.tearDown.wallTime, 1u);
+            EXPECT_EQ(timings.setUp.cpuTime, 10u);
+            EXPECT_EQ(timings.testBody.cpuTime, 10u);
+            EXPECT_EQ(timings.tearDown.cpuTime, 10u);
+            EXPECT_EQ(timings.total().wallTime, 3u);
+            EXPECT_EQ(timings.total().cpuTime, 30u);
+
+            // Timings must survive copying the result
+            TestResult copy{result};
+            EXPECT_EQ(copy.getTimings().total().cpuTime, 30u);
+
+            // No clocks - no times
+            setTimingClocks(nullptr, nullptr);
+            result = TestRunner(*suiteInstance, test).run();
+            resetTimingClocks();
+            EXPECT_ZERO(result.getTimings().total().wallTime);
+            EXPECT_ZERO(result.getTimings().total().cpuTime);
+
+#if OSTEST_POSIX
+            // Default clocks
+            result = TestRunner(*suiteInstance, test).run();
+            EXPECT_NONZERO(result.getTimings().testBody.wallTime);
+            EXPECT_GTEQ(result.getTimings().total().wallTime,
+                result.getTimings().testBody.wallTime);
+#endif
+        }
+        break;
+    }
+}
+
+
+#if !OSTEST_NO_ALLOC
+#include <stdexcept>
+
+namespace selftest
+{
+    TEST_SUITE(_ArenaSuite)
+
+    TEST_EX(::selftest, _ArenaSuite, _ManyAssertions)
+    {
+        // Enough assertions to require several arena blocks
+        for (int i = 0; i < 2000; i++) {
+            EXPECT_EQ_ALL(i % 2, 0);
+        }
+#if OSTEST_STD_EXCEPTIONS
+        throw std::runtime_error(std::string(1000, 'x'));
+#endif
+    }
+}
+
+TEST(ResultSuite, ArenaTest)
+{
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_ArenaSuite") != 0) continue;
+
+        auto suiteInstance = suite.getSingletonSmartPtr();
+        for (auto& test : suite.tests())
+        {
+            TestResult copy{};
+            {
+                // Assertions must outlive the test instance and the original result
+                auto result = TestRunner(*suiteInstance, test).run();
+                copy = result;
+            }
+
+            unsigned int passed = 0, failed = 0;
+            for (auto& assertion : copy.getAssertions())
+            {
+                if (assertion.passed()) passed++;
+                else if (std::strcmp(assertion.expression, "(i % 2) == (0)") == 0) {
+                    failed++;
+                    EXPECT_ZERO_ALL(std::strcmp(assertion.getMessage(), "Expected 1 == 0."));
+                }
+            }
+            EXPECT_EQ(passed, 1000u);
+            EXPECT_EQ(failed, 1000u);
+
+#if OSTEST_STD_EXCEPTIONS
+            // Long exception messages are truncated
+            ASSERT_NEQ(copy.getFinalFailure(), nullptr);
+            const char* message = copy.getFinalFailure()->getMessage();
+            EXPECT_ZERO(std::strncmp(message, "An unhandled exception occurred: std::runtime_error: xxx", 56));
+            EXPECT_EQ(std::strlen(message), 53u + 816u);
+#endif
+        }
+        break;
+    }
+}
+#endif
+
+
+#if OSTEST_STD_EXCEPTIONS
+namespace selftest
+{
+    struct _CustomError { };
+
+    TEST_SUITE(_ExceptionSuite)
+
+    TEST_EX(::selftest, _ExceptionSuite, _StdException) {
+        throw std::out_of_range("out of range");
+    }
+    TEST_EX(::selftest, _ExceptionSuite, _String) {
+        throw std::string("a string");
+    }
+    TEST_EX(::selftest, _ExceptionSuite, _CString) {
+        throw "a C string";
+    }
+    TEST_EX(::selftest, _ExceptionSuite, _Custom) {
+        throw _CustomError{};
+    }
+}
+
+TEST(ResultSuite, ExceptionMessageTest)
+{
+    static const struct { const char* test; const char* message; } expected[] = {
+        {"_StdException", "An unhandled exception occurred: std::out_of_range: out of range"},
+        {"_String",       "An unhandled exception occurred: a string"},
+        {"_CString",      "An unhandled exception occurred: a C string"},
+#if defined(__GNUC__)
+        {"_Custom",       "An unhandled exception occurred: selftest::_CustomError"},
+#else
+        {"_Custom",       "An unhandled exception occurred"},
+#endif
+    };
+
+    unsigned int count = 0;
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_ExceptionSuite") != 0) continue;
+
+        auto suiteInstance = suite.getSingletonSmartPtr();
+        for (auto& test : suite.tests())
+        {
+            auto result = TestRunner(*suiteInstance, test).run();
+            ASSERT_NEQ_ALL(result.getFinalFailure(), nullptr);
+            EXPECT_ZERO_ALL(std::strcmp(result.getFinalFailure()->expression, "<unhandled exception>"));
+
+            for (auto& entry : expected)
+            {
+                if (std::strcmp(entry.test, test.name) != 0) continue;
+                EXPECT_ZERO_ALL(std::strcmp(result.getFinalFailure()->getMessage(), entry.message));
+                count++;
+            }
+        }
+        break;
+    }
+    EXPECT_EQ(count, 4u);
+}
+#endif
+
+
+#if OSTEST_NO_ALLOC
+namespace selftest
+{
+    TEST_SUITE(_PoolSuite)
+
+    TEST_EX(::selftest, _PoolSuite, _PoolOverflow)
+    {
+        // More assertions than fit in the pool, failing only on the final iteration
+        for (int i = 0; i < OSTEST_ASSERTION_POOL_SIZE + 44; i++) {
+            EXPECT_ALL(i != OSTEST_ASSERTION_POOL_SIZE + 43);
+        }
+    }
+}
+
+TEST(ResultSuite, PoolTest)
+{
+    const unsigned int total = OSTEST_ASSERTION_POOL_SIZE + 44;
+
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_PoolSuite") != 0) continue;
+
+        auto suiteInstance = suite.getSingletonSmartPtr();
+        for (auto& test : suite.tests())
+        {
+            // Dropped failures still fail the test
+            setAssertionPoolPolicy(AssertionPoolPolicy::KeepFirst);
+            auto result = TestRunner(*suiteInstance, test).run();
+            unsigned int count = countAssertions(result);
+            EXPECT(!result.succeeded());
+            EXPECT(count < total);
+            EXPECT_EQ(result.getFirstFailure(), nullptr);
+            EXPECT_ZERO(result.getDroppedAssertions());
+
+            // The pool is reused by the next test
+            result = TestRunner(*suiteInstance, test).run();
+            EXPECT_EQ(countAssertions(result), count);
+
+            setAssertionPoolPolicy(AssertionPoolPolicy::DropWithCounter);
+            result = TestRunner(*suiteInstance, test).run();
+            EXPECT(!result.succeeded());
+            EXPECT_EQ(countAssertions(result), count);
+            EXPECT_EQ(result.getDroppedAssertions(), total - count);
+
+            setAssertionPoolPolicy(AssertionPoolPolicy::KeepFailures);
+            result = TestRunner(*suiteInstance, test).run();
+            EXPECT(!result.succeeded());
+            EXPECT_EQ(countAssertions(result), count);
+            EXPECT_NEQ(result.getFirstFailure(), nullptr);
+            EXPECT_EQ(result.getFinalFailure(), result.getFirstFailure());
+
+            setAssertionPoolPolicy(AssertionPoolPolicy::KeepFirst);
+        }
+        break;
+    }
+}
+#endif
+
+
+namespace selftest
+{
+    TEST_SUITE(_RetentionSuite)
+
+    TEST_EX(::selftest, _RetentionSuite, _Mixed)
+    {
+        EXPECT_ONCE(true);
+        for (int i = 0; i < 100; i++) {
+            EXPECT_ALL(i % 25 != 3);
+        }
+        EXPECT_EQ_ALL(1, 1);
+    }
+    TEST_EX(::selftest, _RetentionSuite, _Long)
+    {
+        // More assertions than fit in the assertion pool used with OSTEST_NO_ALLOC
+        for (int i = 0; i < 2000; i++) {
+            EXPECT_ALL(i != 1999);
+        }
+    }
+}
+
+TEST(ResultSuite, RetentionTest)
+{
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_RetentionSuite") != 0) continue;
+
+        auto suiteInstance = suite.getSingletonSmartPtr();
+        for (auto& test : suite.tests())
+        {
+            if (std::strcmp(test.name, "_Mixed") == 0)
+            {
+                TestRunner runner(*suiteInstance, test);
+                auto result = runner.run();
+                EXPECT_EQ(countAssertions(result), 102u);
+                EXPECT_ZERO(result.getReleasedAssertions());
+
+                // Only failures and assertions made once are kept
+                runner.setRetentionPolicy(RetentionPolicy::KeepFailures);
+                result = runner.run();
+                EXPECT_EQ(countAssertions(result), 5u);
+                EXPECT_EQ(result.getPassCount(), 98u);
+                EXPECT_EQ(result.getFailureCount(), 4u);
+                EXPECT_EQ(result.getReleasedAssertions(), 97u);
+                unsigned int passedCount = 0;
+                for (auto& assertion : result.getAssertions()) {
+                    if (assertion.passed()) passedCount++;
+                }
+                EXPECT_EQ(passedCount, 1u);
+
+                // The most recent passes are also kept, in order
+                runner.setRetentionPolicy(RetentionPolicy::KeepLastPasses, 3);
+                result = runner.run();
+                EXPECT_EQ(countAssertions(result), 8u);
+                EXPECT_EQ(result.getPassCount(), 98u);
+                EXPECT_EQ(result.getReleasedAssertions(), 94u);
+
+                AssertionKind kinds[8]{};
+                bool passed[8]{};
+                unsigned int index = 0;
+                for (auto& assertion : result.getAssertions())
+                {
+                    kinds[index] = assertion.getKind();
+                    passed[index++] = assertion.passed();
+                }
+                EXPECT(passed[0] && !passed[1] && !passed[4] && passed[5] && passed[6] && passed[7]);
+                EXPECT(kinds[6] == AssertionKind::Basic && kinds[7] == AssertionKind::Equal);
+            }
+            else
+            {
+                // Released slots are reused, so no assertion is dropped
+                setRetentionPolicy(RetentionPolicy::KeepFailures);
+                auto result = TestRunner(*suiteInstance, test).run();
+                setRetentionPolicy(RetentionPolicy::KeepAll);
+
+                EXPECT_EQ(countAssertions(result), 1u);
+                EXPECT_NEQ(result.getFirstFailure(), nullptr);
+                EXPECT_ZERO(result.getDroppedAssertions());
+                EXPECT_EQ(result.getReleasedAssertions(), 1999u);
+            }
+        }
+        break;
+    }
+}
@@ -0,0 +1,165 @@
+/* shard-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <cstring>
+
+#if !OSTEST_NO_ALLOC
+#include <string>
+#include <vector>
+#endif
+#if OSTEST_POSIX
+#include <stdlib.h>
+#endif
+
+using namespace ostest;
+
+namespace selftest
+{
+    TEST_SUITE(_ShardSuite)
+
+#define SHARD_TEST(name) \
+    TEST_EX(::selftest, _ShardSuite, name) { \
+        EXPECT(true); \
+    }
+
+    SHARD_TEST(_Test1) SHARD_TEST(_Test2) SHARD_TEST(_Test3) SHARD_TEST(_Test4)
+    SHARD_TEST(_Test5) SHARD_TEST(_Test6) SHARD_TEST(_Test7) SHARD_TEST(_Test8)
+
+#undef SHARD_TEST
+
+#if !OSTEST_NO_ALLOC
+    static std::vector<const TestInfo*> _getShardTests()
+    {
+        std::vector<const TestInfo*> tests{};
+        for (auto& suite : getSuites())
+        {
+            if (std::strcmp(suite.name, "_ShardSuite") != 0) continue;
+            for (auto& test : suite.tests()) tests.push_back(&test);
+        }
+        return tests;
+    }
+
+    static void _appendShardLog(void* context, const char* data, size_t length) {
+        static_cast<std::string*>(context)->append(data, length);
+    }
+#endif
+}
+
+
+TEST_SUITE(ShardSuite)
+
+TEST(ShardSuite, TestShardTest)
+{
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_ShardSuite") != 0) continue;
+        for (auto& test : suite.tests())
+        {
+            EXPECT_LT_ALL(getTestShard(test, 3), 3u);
+            EXPECT_EQ_ALL(getTestShard(test, 3), getTestShard(test, 3));
+            EXPECT_EQ_ALL(getTestShard(test, 1), 0u);
+            EXPECT_EQ_ALL(getTestShard(test, 0), 0u);
+        }
+    }
+}
+
+#if !OSTEST_NO_ALLOC
+TEST(ShardSuite, ShardPartitionTest)
+{
+    auto tests = selftest::_getShardTests();
+    ASSERT_EQ(tests.size(), 8u);
+
+    // Each test is selected by exactly one shard, in the order given
+    std::vector<unsigned int> seen(tests.size(), 0);
+    for (unsigned int index = 0; index < 3; index++)
+    {
+        TestShard shard(tests.data(), tests.size(), index, 3);
+        size_t last = 0;
+        for (size_t i = 0; i < shard.getCount(); i++)
+        {
+            size_t position = 0;
+            while (tests[position] != shard.tests()[i]) position++;
+            EXPECT_GTEQ_ALL(position, last);
+            EXPECT_EQ_ALL(getTestShard(*tests[position], 3), index);
+            last = position;
+            seen[position]++;
+        }
+    }
+    for (auto count : seen) EXPECT_EQ_ALL(count, 1u);
+
+    // Removing a test leaves the shards of the others unchanged
+    TestShard full(tests.data(), tests.size(), 1, 3);
+    TestShard partial(tests.data() + 1, tests.size() - 1, 1, 3);
+    size_t expected = full.getCount() - (getTestShard(*tests[0], 3) == 1 ? 1 : 0);
+    ASSERT_EQ(partial.getCount(), expected);
+    for (size_t i = 0; i < partial.getCount(); i++) {
+        EXPECT_EQ_ALL(partial.tests()[i], full.tests()[full.getCount() - expected + i]);
+    }
+}
+
+TEST(ShardSuite, BalancedShardTest)
+{
+    auto tests = selftest::_getShardTests();
+    ASSERT_EQ(tests.size(), 8u);
+
+    // Record one long test and six short tests. The last test has no history.
+    std::string log{};
+    char buffer[256];
+    BinaryReporter reporter(selftest::_appendShardLog, &log, buffer, sizeof(buffer));
+    reporter.begin();
+    for (size_t i = 0; i < 7; i++)
+    {
+        TestResult result{};
+        unsigned long long time = i == 3 ? 100 : 10;
+        result.setTimings(TestTimings{{0, 0}, {time, time}, {0, 0}});
+        reporter.report(*tests[i], result);
+    }
+    reporter.end();
+    ResultLog history(log.data(), log.size());
+    ASSERT(history.valid());
+
+    for (unsigned int index = 0; index < 2; index++)
+    {
+        TestShard shard(tests.data(), tests.size(), index, 2, history);
+
+        bool hasLong = false;
+        unsigned int recorded = 0;
+        for (size_t i = 0; i < shard.getCount(); i++)
+        {
+            if (shard.tests()[i] == tests[3]) hasLong = true;
+            else if (shard.tests()[i] != tests[7]) recorded++;
+        }
+        // The long test is balanced against all six short tests
+        EXPECT_EQ_ALL(recorded, hasLong ? 0u : 6u);
+
+        bool hasUnrecorded = shard.getCount() > recorded + (hasLong ? 1 : 0);
+        EXPECT_EQ_ALL(hasUnrecorded, getTestShard(*tests[7], 2) == index);
+    }
+}
+
+#if OSTEST_POSIX
+TEST(ShardSuite, EnvironmentShardTest)
+{
+    unsigned int index = 7, total = 9;
+
+    ::unsetenv("OSTEST_SHARD_INDEX");
+    ::unsetenv("OSTEST_TOTAL_SHARDS");
+    EXPECT(!TestShard::getEnvironmentShard(index, total));
+
+    ::setenv("OSTEST_SHARD_INDEX", "4", 1);
+    ::setenv("OSTEST_TOTAL_SHARDS", "4", 1);
+    EXPECT(!TestShard::getEnvironmentShard(index, total));
+    ::setenv("OSTEST_TOTAL_SHARDS", "x16", 1);
+    EXPECT(!TestShard::getEnvironmentShard(index, total));
+    EXPECT_EQ(index, 7u);
+    EXPECT_EQ(total, 9u);
+
+    ::setenv("OSTEST_TOTAL_SHARDS", "16", 1);
+    EXPECT(TestShard::getEnvironmentShard(index, total));
+    EXPECT_EQ(index, 4u);
+    EXPECT_EQ(total, 16u);
+
+    ::unsetenv("OSTEST_SHARD_INDEX");
+    ::unsetenv("OSTEST_TOTAL_SHARDS");
+}
+#endif
+#endif
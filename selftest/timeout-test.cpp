@@ -0,0 +1,227 @@
+/* timeout-test.cpp - (c) 2018 James Renwick */
+#include "common.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ostest;
+
+#if OSTEST_POSIX && OSTEST_STD_THREADS
+namespace selftest
+{
+    TEST_SUITE(_TimeoutSuite)
+
+    TEST_EX(::selftest, _TimeoutSuite, _TestHang) {
+        EXPECT(true);
+        while (true) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    TEST_EX(::selftest, _TimeoutSuite, _TestFast) {
+        EXPECT(true);
+    }
+    TEST_EX(::selftest, _TimeoutSuite, _TestLongAllowed) {
+        static Metadata<unsigned int> timeout(*this, METADATA_NAME("timeout_ms"), 10000u);
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        EXPECT(true);
+    }
+    TEST_EX(::selftest, _TimeoutSuite, _TestShortOverride) {
+        static Metadata<unsigned int> timeout(*this, METADATA_NAME("timeout_ms"), 20u);
+        while (true) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    TEST_EX(::selftest, _TimeoutSuite, _TestExitStatus) {
+        // Previously taken to be the status of a child whose test timed out
+        std::_Exit(124);
+    }
+
+    TEST_SUITE(_TimeoutDefaultSuite)
+
+    TEST_EX(::selftest, _TimeoutDefaultSuite, _TestHang) {
+        static Metadata<unsigned int> timeout(*this, METADATA_NAME("timeout_ms"), 30u);
+        while (true) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    TEST_EX(::selftest, _TimeoutDefaultSuite, _TestFast) {
+        static Metadata<unsigned int> timeout(*this, METADATA_NAME("timeout_ms"), 10000u);
+        EXPECT(true);
+    }
+
+    TEST_SUITE(_TimeoutHandlerSuite)
+
+    TEST_EX(::selftest, _TimeoutHandlerSuite, _TestSlow) {
+        static Metadata<unsigned int> timeout(*this, METADATA_NAME("timeout_ms"), 30u);
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        EXPECT(true);
+    }
+
+    // Records the results of tests run in child processes
+    class _TimeoutRecordingRunner : public IsolatedRunner
+    {
+    public:
+        std::vector<const TestInfo*> completed{};
+        std::vector<TestResult> results{};
+
+        using IsolatedRunner::IsolatedRunner;
+
+    protected:
+        void notifyComplete(const TestInfo& info, const TestResult& result) override
+        {
+            completed.push_back(&info);
+            results.push_back(result);
+        }
+    };
+
+    // Writes the results of tests to a pipe, one line per test
+    class _TimeoutPipeRunner : public TestRunner
+    {
+    public:
+        int output;
+
+        _TimeoutPipeRunner(TestSuite& suite, const TestInfo& test, int output)
+            : TestRunner(suite, test), output(output) { }
+
+    protected:
+        void notifyComplete(const TestInfo& info, const TestResult& result) override
+        {
+            std::string line = info.name;
+            if (auto failure = result.getFirstFailure()) {
+                line = line + ' ' + failure->expression + ' ' + failure->getMessage();
+            }
+            line += '\n';
+            if (write(output, line.data(), line.size()) < 0) std::_Exit(2);
+        }
+    };
+
+    // Tests timed out, recorded on the watchdog thread
+    static std::atomic<const TestInfo*> timedOut{nullptr};
+    static std::atomic<unsigned int> timeoutCount{0};
+
+    static void _recordTimeout(const TestInfo& info)
+    {
+        timedOut.store(&info);
+        timeoutCount++;
+    }
+}
+
+
+TEST_SUITE(TimeoutSuite)
+
+TEST(TimeoutSuite, IsolatedTimeoutTest)
+{
+    std::vector<const TestInfo*> tests{};
+
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_TimeoutSuite") != 0) continue;
+        for (auto& test : suite.tests()) tests.push_back(&test);
+    }
+    ASSERT_EQ(tests.size(), 5u);
+
+    // All tests in a single batch, so those after each timeout must be rescheduled
+    setDefaultTimeout(100);
+    EXPECT_EQ(getDefaultTimeout(), 100u);
+    selftest::_TimeoutRecordingRunner runner(1, 4);
+    runner.run(tests.data(), tests.size());
+    setDefaultTimeout(0);
+
+    ASSERT_EQ(runner.completed.size(), tests.size());
+    for (size_t i = 0; i < tests.size(); i++)
+    {
+        const TestInfo& test = *runner.completed[i];
+        const TestResult& result = runner.results[i];
+        EXPECT_EQ_ALL(&test, tests[i]);
+
+        if (std::strcmp(test.name, "_TestFast") == 0 || std::strcmp(test.name, "_TestLongAllowed") == 0) {
+            EXPECT_ALL(result.succeeded());
+        }
+        else if (std::strcmp(test.name, "_TestExitStatus") == 0)
+        {
+            ASSERT_ALL(result.getFirstFailure() != nullptr);
+            EXPECT_ALL(std::strcmp(result.getFirstFailure()->expression, "<process terminated>") == 0);
+            EXPECT_ALL(std::strcmp(result.getFirstFailure()->getMessage(),
+                "The test process exited unexpectedly with status 124.") == 0);
+        }
+        else
+        {
+            ASSERT_ALL(result.getFirstFailure() != nullptr);
+            EXPECT_ALL(std::strcmp(result.getFirstFailure()->expression, "<timeout>") == 0);
+            EXPECT_ALL(std::strcmp(result.getFirstFailure()->getMessage(),
+                "The test did not complete within its timeout.") == 0);
+            EXPECT_EQ_ALL(result.getFirstFailure()->line, test.line);
+        }
+    }
+}
+
+TEST(TimeoutSuite, DefaultTimeoutTest)
+{
+    SuiteInfo* suiteInfo = nullptr;
+    const TestInfo* fast = nullptr;
+    const TestInfo* hang = nullptr;
+
+    for (auto& suite : getSuites())
+    {
+        if (std::strcmp(suite.name, "_TimeoutDefaultSuite") != 0) continue;
+        suiteInfo = &suite;
+        for (auto& test : suite.tests()) {
+            (std::strcmp(test.name, "_TestFast") == 0 ? fast : hang) = &test;
+        }
+    }
+    ASSERT(suiteInfo != nullptr && fast != nullptr && hang != nullptr);
+
+    int pipes[2];
+    ASSERT_EQ(pipe(pipes), 0);
+    pid_t child = fork();
+    ASSERT(child >= 0);
+
+    // The hanging test is reported, then the process ends without running any further tests
+    if (child == 0)
+    {
+        close(pipes[0]);
+        _ostest_internal::_resetWatchdog(nullptr);
+
+        auto suite = suiteInfo->getSingletonSmartPtr();
+        selftest::_TimeoutPipeRunner(*suite, *fast, pipes[1]).run();
+        selftest::_TimeoutPipeRunner(*suite, *hang, pipes[1]).run();
+        selftest::_TimeoutPipeRunner(*suite, *fast, pipes[1]).run();
+        std::_Exit(0);
+    }
+    close(pipes[1]);
+
+    std::string output{};
+    char buffer[256];
+    ssize_t count;
+    while ((count = read(pipes[0], buffer, sizeof(buffer))) > 0) output.append(buffer, static_cast<size_t>(count));
+    close(pipes[0]);
+
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    EXPECT(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE);
+    EXPECT(output == "_TestFast\n_TestHang <timeout> The test did not complete within its timeout.\n");
+}
+
+TEST(TimeoutSuite, TimeoutHandlerTest)
+{
+    selftest::timedOut.store(nullptr);
+    selftest::timeoutCount.store(0);
+    setTimeoutHandler(&selftest::_recordTimeout);
+
+    for (auto& suiteInfo : getSuites())
+    {
+        if (std::strcmp(suiteInfo.name, "_TimeoutHandlerSuite") != 0) continue;
+
+        auto suite = suiteInfo.getSingletonSmartPtr();
+        for (auto& test : suiteInfo.tests())
+        {
+            // The test continues once the handler returns
+            EXPECT_ALL(TestRunner(*suite, test).run().succeeded());
+
+            EXPECT_EQ_ALL(selftest::timeoutCount.load(), 1u);
+            EXPECT_EQ_ALL(selftest::timedOut.load(), &test);
+        }
+    }
+    setTimeoutHandler(nullptr);
+}
+#endif